@@ -0,0 +1,558 @@
+#include <algorithm>                                                          // max()
+#include <atomic>                                                             // atomic_ref
+#include <cerrno>                                                             // errno, EINTR
+#include <condition_variable>                                                 // condition_variable, condition_variable_any
+#include <coroutine>                                                          // coroutine_handle, suspend_always
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint64_t
+#include <deque>
+#include <exception>                                                          // exception_ptr, current_exception(), rethrow_exception()
+#include <memory>                                                             // unique_ptr, make_unique()
+#include <mutex>
+#include <span>
+#include <stdexcept>                                                          // invalid_argument
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <system_error>                                                       // system_error, generic_category()
+#include <thread>                                                             // jthread
+#include <utility>                                                            // exchange()
+#include <vector>
+
+#include <fcntl.h>                                                            // open(), posix_fadvise()
+#include <sys/uio.h>                                                          // iovec
+#include <unistd.h>                                                           // pread(), close()
+
+#if __has_include( <linux/io_uring.h> )
+  #define GROCERY_DB_HAS_IO_URING
+  #include <linux/io_uring.h>                                                 // io_uring_params, io_uring_sqe, io_uring_cqe
+  #include <sys/mman.h>                                                       // mmap(), munmap()
+  #include <sys/syscall.h>                                                    // __NR_io_uring_setup, __NR_io_uring_enter
+#endif
+
+#include "AsyncFileReader.hpp"
+
+
+
+/*******************************************************************************
+**  Implementation of non-member private types, objects, and functions
+*******************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  // One chunk's buffer, its read, and the coroutine waiting for that read to finish
+  struct Read
+  {
+    std::vector<char>       buffer;
+    std::uint64_t           offset = 0;                                       // file offset of buffer[0]
+    iovec                   vector{};                                         // what's being read, for io_uring
+    bool                    done   = true;
+    long                    result = 0;                                       // bytes read, or -errno
+    std::coroutine_handle<> waiter;
+  };
+
+
+
+
+  // Where reads are carried out.  Reads complete in any order; complete() returns whichever finishes next
+  class ReadQueue
+  {
+    public:
+      virtual ~ReadQueue() = default;                                         // Waits out, or abandons, reads still in flight
+
+      virtual std::string_view name    () const noexcept = 0;
+      virtual void             submit  ( int file, Read & read, std::size_t filled ) = 0;   // Reads read.buffer[filled..] from read.offset + filled
+      virtual Read &           complete() = 0;                                // Waits for a read to finish and records its result
+  };
+
+
+
+
+  // The portable backend:  one thread working through the reads in submission order with pread()
+  class ThreadReadQueue final : public ReadQueue
+  {
+    public:
+      std::string_view name() const noexcept override { return "read-ahead thread"; }
+
+      void submit( int file, Read & read, std::size_t filled ) override
+      {
+        read.done   = false;
+        read.waiter = {};
+
+        std::scoped_lock lock( _mutex );
+        _requests.push_back( { file, &read, filled } );
+        _wakeup.notify_one();
+      }
+
+      Read & complete() override
+      {
+        std::unique_lock lock( _mutex );
+        _ready.wait( lock, [this] { return !_completions.empty(); } );
+
+        Read & read = *_completions.front();
+        _completions.pop_front();
+        read.done = true;
+        return read;
+      }
+
+    private:
+      struct Request
+      {
+        int         file;
+        Read *      read;
+        std::size_t filled;
+      };
+
+      void run( std::stop_token stopToken )
+      {
+        std::unique_lock lock( _mutex );
+        while( _wakeup.wait( lock, stopToken, [this] { return !_requests.empty(); } ) )
+        {
+          Request request = _requests.front();
+          _requests.pop_front();
+          lock.unlock();
+
+          Read & read   = *request.read;
+          long   result = 0;
+          do result = ::pread( request.file, read.buffer.data() + request.filled, read.buffer.size() - request.filled,
+                               static_cast<off_t>( read.offset + request.filled ) );
+          while( result < 0 && errno == EINTR );
+
+          lock.lock();
+          read.result = result < 0 ? -errno : result;
+          _completions.push_back( &read );
+          _ready.notify_one();
+        }
+      }
+
+      std::mutex                  _mutex;
+      std::condition_variable_any _wakeup;                                    // signals _requests
+      std::condition_variable     _ready;                                     // signals _completions
+      std::deque<Request>         _requests;
+      std::deque<Read *>          _completions;
+      std::jthread                _worker{ [this]( std::stop_token stopToken ) { run( stopToken ); } };   // declared last so it stops first
+  };
+
+
+
+
+#ifdef GROCERY_DB_HAS_IO_URING
+  // The io_uring backend, talking to the kernel directly (no liburing).  The submission and completion rings are shared with the
+  // kernel:  this side only writes the submission tail and the completion head, with release semantics, and reads the kernel's
+  // side with acquire semantics.  Reads use IORING_OP_READV, which every io_uring capable kernel supports.
+  class IoUringReadQueue final : public ReadQueue
+  {
+    public:
+      explicit IoUringReadQueue( unsigned entries )                           // Throws std::system_error if the kernel won't set up a ring
+      {
+        io_uring_params parameters{};
+        _ring = static_cast<int>( ::syscall( __NR_io_uring_setup, entries, &parameters ) );
+        if( _ring < 0 ) throw std::system_error( errno, std::generic_category(), "Error - Could not set up io_uring" );
+
+        try
+        {
+          _submissionBytes = parameters.sq_off.array + parameters.sq_entries * sizeof( unsigned );
+          _completionBytes = parameters.cq_off.cqes  + parameters.cq_entries * sizeof( io_uring_cqe );
+          bool shared      = parameters.features & IORING_FEAT_SINGLE_MMAP;
+          if( shared ) _submissionBytes = _completionBytes = std::max( _submissionBytes, _completionBytes );
+
+          _submissionRing  = map( _submissionBytes, IORING_OFF_SQ_RING );
+          _completionRing  = shared ? _submissionRing : map( _completionBytes, IORING_OFF_CQ_RING );
+          _entriesBytes    = parameters.sq_entries * sizeof( io_uring_sqe );
+          _entries         = static_cast<io_uring_sqe *>( map( _entriesBytes, IORING_OFF_SQES ) );
+
+          _submissionTail  = field<unsigned>( _submissionRing, parameters.sq_off.tail         );
+          _submissionMask  = *field<unsigned>( _submissionRing, parameters.sq_off.ring_mask   );
+          _submissionArray = field<unsigned>( _submissionRing, parameters.sq_off.array        );
+          _completionHead  = field<unsigned>( _completionRing, parameters.cq_off.head         );
+          _completionTail  = field<unsigned>( _completionRing, parameters.cq_off.tail         );
+          _completionMask  = *field<unsigned>( _completionRing, parameters.cq_off.ring_mask   );
+          _completions     = field<io_uring_cqe>( _completionRing, parameters.cq_off.cqes     );
+        }
+        catch( ... )
+        {
+          release();
+          throw;
+        }
+      }
+
+     ~IoUringReadQueue() override
+      {
+        // The kernel writes into the buffers until each read completes, so wait for them all before the buffers can go away
+        try { while( _outstanding > 0 ) complete(); }
+        catch( ... ) {}
+        release();
+      }
+
+      std::string_view name() const noexcept override { return "io_uring"; }
+
+      void submit( int file, Read & read, std::size_t filled ) override
+      {
+        read.done   = false;
+        read.waiter = {};
+        read.vector = { read.buffer.data() + filled, read.buffer.size() - filled };
+
+        unsigned       tail  = *_submissionTail;                              // only this side writes the tail
+        unsigned       index = tail & _submissionMask;
+        io_uring_sqe & entry = _entries[index];
+        entry           = {};
+        entry.opcode    = IORING_OP_READV;
+        entry.fd        = file;
+        entry.addr      = reinterpret_cast<std::uint64_t>( &read.vector );
+        entry.len       = 1;
+        entry.off       = read.offset + filled;
+        entry.user_data = reinterpret_cast<std::uint64_t>( &read );
+        _submissionArray[index] = index;
+        std::atomic_ref<unsigned>( *_submissionTail ).store( tail + 1, std::memory_order_release );
+
+        enter( 1, 0, 0 );
+        ++_outstanding;
+      }
+
+      Read & complete() override
+      {
+        unsigned head = *_completionHead;                                     // only this side writes the head
+        while( head == std::atomic_ref<unsigned>( *_completionTail ).load( std::memory_order_acquire ) ) enter( 0, 1, IORING_ENTER_GETEVENTS );
+
+        io_uring_cqe const & entry = _completions[head & _completionMask];
+        Read &               read  = *reinterpret_cast<Read *>( entry.user_data );
+        read.result = entry.res;
+        read.done   = true;
+        std::atomic_ref<unsigned>( *_completionHead ).store( head + 1, std::memory_order_release );
+
+        --_outstanding;
+        return read;
+      }
+
+    private:
+      void * map( std::size_t bytes, off_t offset )
+      {
+        void * region = ::mmap( nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring, offset );
+        if( region == MAP_FAILED ) throw std::system_error( errno, std::generic_category(), "Error - Could not map the io_uring rings" );
+        return region;
+      }
+
+      template<typename T>
+      static T * field( void * ring, unsigned offset )
+      {
+        return reinterpret_cast<T *>( static_cast<char *>( ring ) + offset );
+      }
+
+      void enter( unsigned submit, unsigned waitFor, unsigned flags )
+      {
+        while( ::syscall( __NR_io_uring_enter, _ring, submit, waitFor, flags, nullptr, 0 ) < 0 )
+        {
+          if( errno != EINTR ) throw std::system_error( errno, std::generic_category(), "Error - io_uring_enter failed" );
+        }
+      }
+
+      void release() noexcept
+      {
+        if( _entries        != nullptr )                                  ::munmap( _entries,        _entriesBytes    );
+        if( _completionRing != nullptr && _completionRing != _submissionRing ) ::munmap( _completionRing, _completionBytes );
+        if( _submissionRing != nullptr )                                  ::munmap( _submissionRing, _submissionBytes );
+        ::close( _ring );
+      }
+
+      int            _ring            = -1;
+      std::size_t    _outstanding     = 0;
+
+      void *         _submissionRing  = nullptr;
+      std::size_t    _submissionBytes = 0;
+      void *         _completionRing  = nullptr;
+      std::size_t    _completionBytes = 0;
+      io_uring_sqe * _entries         = nullptr;
+      std::size_t    _entriesBytes    = 0;
+
+      unsigned *     _submissionTail  = nullptr;
+      unsigned       _submissionMask  = 0;
+      unsigned *     _submissionArray = nullptr;
+      unsigned *     _completionHead  = nullptr;
+      unsigned *     _completionTail  = nullptr;
+      unsigned       _completionMask  = 0;
+      io_uring_cqe * _completions     = nullptr;
+  };
+#endif
+
+
+
+
+  std::unique_ptr<ReadQueue> makeReadQueue( AsyncFileReader::Backend backend, std::size_t depth )
+  {
+    using Backend = AsyncFileReader::Backend;
+
+#ifdef GROCERY_DB_HAS_IO_URING
+    if( backend != Backend::ReadAheadThread )
+    {
+      try
+      {
+        return std::make_unique<IoUringReadQueue>( static_cast<unsigned>( depth ) );
+      }
+      catch( std::system_error & )                                            // an old kernel, or io_uring disabled by policy
+      {
+        if( backend == Backend::IoUring ) throw;
+      }
+    }
+#else
+    if( backend == Backend::IoUring ) throw std::invalid_argument( "Error - io_uring isn't available on this platform" );
+#endif
+
+    return std::make_unique<ThreadReadQueue>();
+  }
+
+
+
+
+  // co_await on a Read suspends the coroutine until the read finishes, and yields its result
+  struct ReadAwaiter
+  {
+    Read & read;
+
+    bool await_ready  () const noexcept                          { return read.done;   }
+    void await_suspend( std::coroutine_handle<> waiter ) noexcept { read.waiter = waiter; }
+    long await_resume () const noexcept                          { return read.result; }
+  };
+
+
+
+
+  // The coroutine type for the read pipeline:  a generator of chunks that is also the scheduler for its own reads.  next() resumes
+  // the coroutine and, whenever it suspends waiting on a read, completes reads - resuming it once the one it's waiting on is done -
+  // until it yields the next chunk
+  class Chunks
+  {
+    public:
+      struct promise_type
+      {
+        std::span<char>    chunk;
+        bool               yielded = false;
+        std::exception_ptr error;
+
+        Chunks              get_return_object  ()                      { return Chunks( Handle::from_promise( *this ) ); }
+        std::suspend_always initial_suspend    () noexcept              { return {}; }
+        std::suspend_always final_suspend      () noexcept              { return {}; }
+        std::suspend_always yield_value        ( std::span<char> next ) { chunk = next;  yielded = true;  return {}; }
+        void                return_void        () noexcept              {}
+        void                unhandled_exception() noexcept              { error = std::current_exception(); }
+      };
+      using Handle = std::coroutine_handle<promise_type>;
+
+      Chunks( Chunks && other ) noexcept : _handle( std::exchange( other._handle, nullptr ) ) {}
+      Chunks & operator=( Chunks && ) = delete;
+     ~Chunks() { if( _handle ) _handle.destroy(); }
+
+      std::span<char> next( ReadQueue & queue )                              // Returns an empty span at the end of the file
+      {
+        promise_type & promise = _handle.promise();
+        promise.yielded = false;
+        if( _handle.done() ) return {};
+
+        _handle.resume();
+        while( !_handle.done() && !promise.yielded )
+        {
+          Read & read = queue.complete();
+          if( read.waiter ) std::exchange( read.waiter, nullptr ).resume();
+        }
+
+        if( promise.error ) std::rethrow_exception( std::exchange( promise.error, nullptr ) );
+        return promise.yielded ? promise.chunk : std::span<char>{};
+      }
+
+    private:
+      explicit Chunks( Handle handle ) : _handle( handle ) {}
+
+      Handle _handle;
+  };
+
+
+
+
+  // The read pipeline.  Every buffer starts out with a read in flight.  Each chunk is yielded as soon as its read completes, in file
+  // order, and once the reader is done with it (asks for the next) its buffer is reused for the chunk reads.size() ahead
+  Chunks readChunks( ReadQueue & queue, int file, std::span<Read> reads )
+  {
+    std::uint64_t ahead = 0;                                                  // file offset of the next chunk to read
+    auto issue = [&]( Read & read )
+    {
+      read.offset = ahead;
+      ahead      += read.buffer.size();
+      queue.submit( file, read, 0 );
+    };
+    for( auto && read : reads ) issue( read );
+
+    for( std::size_t slot = 0; ; slot = ( slot + 1 ) % reads.size() )
+    {
+      Read &      read   = reads[slot];
+      std::size_t filled = 0;
+      for( ;; )
+      {
+        long result = co_await ReadAwaiter{ read };
+        if( result < 0 ) throw std::system_error( static_cast<int>( -result ), std::generic_category(), "Error - Could not read the file" );
+
+        filled += static_cast<std::size_t>( result );
+        if( result == 0 || filled == read.buffer.size() ) break;
+        queue.submit( file, read, filled );                                   // a short read before the end of the file - fetch the rest
+      }
+
+      if( filled == 0 ) co_return;                                            // end of file
+      co_yield std::span<char>( read.buffer.data(), filled );
+      if( filled < read.buffer.size() ) co_return;                            // that was the last, partial, chunk
+
+      issue( read );
+    }
+  }
+
+
+
+
+  struct FileDescriptor
+  {
+    int value = -1;
+
+    explicit FileDescriptor( int descriptor ) : value( descriptor ) {}
+    FileDescriptor( const FileDescriptor & ) = delete;
+   ~FileDescriptor() { if( value >= 0 ) ::close( value ); }
+  };
+}    // unnamed, anonymous namespace
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  The pipeline
+*******************************************************************************/
+// Members are destroyed in reverse order:  first the coroutine, then the queue - which waits out reads still in flight - and only
+// then the buffers they were reading into, and the file
+struct AsyncFileReader::Pipeline
+{
+  Pipeline( int descriptor, Backend backend, std::size_t chunkSize, std::size_t depth )
+    : file  ( descriptor ),
+      reads ( makeReads( chunkSize, depth ) ),
+      queue ( makeReadQueue( backend, depth ) ),
+      chunks( readChunks( *queue, file.value, reads ) )
+  {}
+
+  static std::vector<Read> makeReads( std::size_t chunkSize, std::size_t depth )
+  {
+    std::vector<Read> reads( depth );
+    for( auto && read : reads ) read.buffer.resize( chunkSize );
+    return reads;
+  }
+
+  FileDescriptor             file;
+  std::vector<Read>          reads;
+  std::unique_ptr<ReadQueue> queue;
+  Chunks                     chunks;
+};
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Construction and destruction
+*******************************************************************************/
+
+// AsyncFileReader(...)
+AsyncFileReader::AsyncFileReader( std::string const & filename, Backend backend, std::size_t chunkSize, std::size_t depth )
+{
+  if( chunkSize < MIN_CHUNK_SIZE || depth == 0 )
+  {
+    throw std::invalid_argument( "Error - AsyncFileReader needs a chunk size of at least " + std::to_string( MIN_CHUNK_SIZE ) + " bytes and a non-zero depth" );
+  }
+
+  int descriptor = ::open( filename.c_str(), O_RDONLY | O_CLOEXEC );
+  if( descriptor < 0 ) return;                                                // is_open() reports it, as std::ifstream does
+
+  ::posix_fadvise( descriptor, 0, 0, POSIX_FADV_SEQUENTIAL );
+  _pipeline = std::make_unique<Pipeline>( descriptor, backend, chunkSize, depth );
+}
+
+
+
+
+// Destructor
+AsyncFileReader::~AsyncFileReader() = default;
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Queries
+*******************************************************************************/
+
+// is_open()
+bool AsyncFileReader::is_open() const noexcept
+{
+  return _pipeline != nullptr;
+}
+
+
+
+
+// backend()
+std::string_view AsyncFileReader::backend() const noexcept
+{
+  return _pipeline ? _pipeline->queue->name() : std::string_view{};
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Stream buffer overrides
+*******************************************************************************/
+
+// underflow()
+AsyncFileReader::int_type AsyncFileReader::underflow()
+{
+  if( gptr() < egptr() ) return traits_type::to_int_type( *gptr() );
+  if( !_pipeline )       return traits_type::eof();
+
+  _chunkOffset += static_cast<std::uint64_t>( egptr() - eback() );
+  std::span<char> chunk = _pipeline->chunks.next( *_pipeline->queue );
+  setg( chunk.data(), chunk.data(), chunk.data() + chunk.size() );
+
+  return chunk.empty() ? traits_type::eof() : traits_type::to_int_type( *gptr() );
+}
+
+
+
+
+// seekoff(...)
+AsyncFileReader::pos_type AsyncFileReader::seekoff( off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which )
+{
+  off_type current = static_cast<off_type>( _chunkOffset ) + ( gptr() - eback() );
+
+  if( direction == std::ios_base::beg ) return seekpos( pos_type( offset           ), which );
+  if( direction == std::ios_base::cur ) return seekpos( pos_type( current + offset ), which );
+  return pos_type( off_type( -1 ) );                                          // the end isn't known until it's reached
+}
+
+
+
+
+// seekpos(...)
+AsyncFileReader::pos_type AsyncFileReader::seekpos( pos_type position, std::ios_base::openmode which )
+{
+  off_type target = off_type( position );
+  off_type first  = static_cast<off_type>( _chunkOffset );
+  if( !( which & std::ios_base::in ) || target < first || target > first + ( egptr() - eback() ) ) return pos_type( off_type( -1 ) );
+
+  setg( eback(), eback() + ( target - first ), egptr() );
+  return position;
+}
@@ -0,0 +1,58 @@
+#pragma once                                                                  // include guard
+
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint64_t
+#include <memory>                                                             // unique_ptr
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+
+
+
+// A read only stream buffer that reads a file with large asynchronous reads, several in flight at once, so the next chunk is on its
+// way from storage while the reader parses the current one.  Wrap it in an std::istream and read from that as if reading an
+// std::ifstream.  It reads bytes and knows nothing of the format, so other stream buffers stack on top of it as they do on a
+// std::filebuf - a BlockDecompressor, for example:
+//
+//     AsyncFileReader file( "Grocery_UPC_Database-Full.datz" );
+//     std::istream    fin( &file );
+//     if( file.is_open() && isBlockCompressed( fin ) ) ...
+//
+// The read pipeline is a C++20 coroutine that issues the reads and yields each chunk, in file order, as its read completes.  Reads
+// go through io_uring when the kernel allows it, otherwise through a read-ahead thread calling pread().
+//
+// Seeking is limited to the chunk being read:  enough for tellg() and seekg() back to a position just read, as when checking a file's
+// magic, but not for random access.  So a chunk must hold at least the MIN_CHUNK_SIZE bytes a reader may peek at from a position and
+// then seek back over - more than isBlockCompressed()'s magic - or the seek back would fail once those bytes spanned two chunks.
+class AsyncFileReader : public std::streambuf
+{
+  public:
+    enum class Backend { Automatic, IoUring, ReadAheadThread };
+
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+    static constexpr std::size_t MIN_CHUNK_SIZE     = 64;
+    static constexpr std::size_t DEFAULT_DEPTH      = 4;                      // reads in flight
+
+    // Throws std::invalid_argument if chunkSize is less than MIN_CHUNK_SIZE or depth is 0
+    explicit AsyncFileReader( std::string const & filename, Backend backend = Backend::Automatic,
+                              std::size_t chunkSize = DEFAULT_CHUNK_SIZE, std::size_t depth = DEFAULT_DEPTH );
+   ~AsyncFileReader() override;
+
+    AsyncFileReader            ( const AsyncFileReader & ) = delete;
+    AsyncFileReader & operator=( const AsyncFileReader & ) = delete;
+
+    bool             is_open() const noexcept;                                // false if the file couldn't be opened
+    std::string_view backend() const noexcept;                                // "io_uring" or "read-ahead thread", once open
+
+  protected:
+    int_type underflow() override;
+    pos_type seekoff  ( off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which ) override;
+    pos_type seekpos  ( pos_type position,                                 std::ios_base::openmode which ) override;
+
+  private:
+    struct Pipeline;                                                          // the file, the reads in flight, and the coroutine issuing them
+
+    std::unique_ptr<Pipeline> _pipeline;
+    std::uint64_t             _chunkOffset = 0;                               // file offset of the chunk in the get area
+};
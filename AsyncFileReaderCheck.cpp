@@ -0,0 +1,106 @@
+#include <cstddef>                                                                        // size_t
+#include <exception>                                                                      // exception
+#include <fstream>                                                                        // filebuf
+#include <iostream>                                                                       // cout, cerr
+#include <iterator>                                                                       // istreambuf_iterator
+#include <optional>
+#include <stdexcept>                                                                      // invalid_argument
+#include <streambuf>
+#include <string>
+
+#include "AsyncFileReader.hpp"
+#include "BlockCompression.hpp"
+
+
+
+namespace
+{
+  // Reads everything in file, as GroceryItemDatabase does:  recognizes a block compressed file by its magic, seeking back to the
+  // start of a plain one, and decompresses it on the fly
+  std::string readAll( std::streambuf & file )
+  {
+    std::optional<BlockDecompressor> decompressor;
+    std::istream                     fin( &file );
+    std::istream                     input( &file );
+    if( isBlockCompressed( fin ) ) input.rdbuf( &decompressor.emplace( fin ) );
+
+    std::string contents( std::istreambuf_iterator<char>( input ), {} );
+    if( input.bad() ) throw std::runtime_error( "Error - Reading failed after " + std::to_string( contents.size() ) + " bytes" );
+    return contents;
+  }
+}    // namespace
+
+
+
+
+// main()
+//    AsyncFileReaderCheck file...
+//
+// Checks that AsyncFileReader reads each file - plain or block compressed - exactly as std::ifstream does, with each backend, with
+// chunk sizes from AsyncFileReader::MIN_CHUNK_SIZE up (odd sizes included, so the magic and the blocks straddle chunks), and with 1
+// to 8 reads in flight.  Also checks that a chunk size below the minimum is refused.  Prints each mismatch, and exits with status 1
+// if there are any.
+//    Ex:  AsyncFileReaderCheck Grocery_UPC_Database-Full.dat Grocery_UPC_Database-Full.datz
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    if( argc < 2 )
+    {
+      std::cerr << "Usage:  " << argv[0] << " file...\n";
+      return 2;
+    }
+
+    constexpr AsyncFileReader::Backend BACKENDS[]    = { AsyncFileReader::Backend::IoUring, AsyncFileReader::Backend::ReadAheadThread };
+    constexpr std::size_t              CHUNK_SIZES[] = { AsyncFileReader::MIN_CHUNK_SIZE, AsyncFileReader::MIN_CHUNK_SIZE + 1, 4093,
+                                                         64 * 1024, AsyncFileReader::DEFAULT_CHUNK_SIZE };
+    constexpr std::size_t              DEPTHS[]      = { 1, 3, 8 };
+
+    std::size_t checks     = 0;
+    std::size_t mismatches = 0;
+
+    try
+    {
+      AsyncFileReader tooSmall( argv[1], AsyncFileReader::Backend::Automatic, AsyncFileReader::MIN_CHUNK_SIZE - 1 );
+      std::cout << "Mismatch:  a chunk size of " << AsyncFileReader::MIN_CHUNK_SIZE - 1 << " bytes was accepted\n";
+      ++mismatches;
+    }
+    catch( std::invalid_argument & ) { ++checks; }
+
+    for( int i = 1; i < argc; ++i )
+    {
+      std::filebuf plainFile;
+      if( plainFile.open( argv[i], std::ios::in | std::ios::binary ) == nullptr )
+      {
+        std::cerr << "Error:  Could not open \"" << argv[i] << "\"\n";
+        return 1;
+      }
+      std::string expected = readAll( plainFile );
+
+      for( auto backend : BACKENDS ) for( auto chunkSize : CHUNK_SIZES ) for( auto depth : DEPTHS )
+      {
+        AsyncFileReader file( argv[i], backend, chunkSize, depth );
+        std::string     actual;
+        std::string     failure;
+        try                         { actual  = readAll( file ); }
+        catch( std::exception & ex ) { failure = ex.what();       }
+
+        ++checks;
+        if( failure.empty() && actual == expected ) continue;
+
+        ++mismatches;
+        std::cout << "Mismatch:  \"" << argv[i] << "\" through " << file.backend() << ", " << chunkSize << " byte chunks, " << depth << " deep:  "
+                  << ( failure.empty() ? "read " + std::to_string( actual.size() ) + " bytes, expected " + std::to_string( expected.size() ) : failure ) << '\n';
+      }
+    }
+
+    std::cout << checks - mismatches << " of " << checks << " checks passed\n";
+    return mismatches == 0 ? 0 : 1;
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+}
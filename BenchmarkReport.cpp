@@ -0,0 +1,21 @@
+#include <chrono>                                                             // duration
+#include <cstddef>                                                            // size_t
+#include <iostream>                                                           // cout
+#include <string_view>
+
+#include "BenchmarkReport.hpp"
+
+
+
+// report(...)
+void report( std::string_view benchmark, std::size_t records, std::size_t operations, std::chrono::steady_clock::duration elapsed, double checksum )
+{
+  double seconds = std::chrono::duration<double>( elapsed ).count();
+  std::cout << "{\"benchmark\":\""    << benchmark                                                              << "\","
+            <<  "\"records\":"        << records                                                                << ','
+            <<  "\"operations\":"     << operations                                                             << ','
+            <<  "\"seconds\":"        << seconds                                                                << ','
+            <<  "\"ns_per_op\":"      << ( operations == 0 ? 0.0 : seconds * 1e9 / static_cast<double>( operations ) ) << ','
+            <<  "\"ops_per_second\":" << ( seconds == 0.0  ? 0.0 : static_cast<double>( operations ) / seconds )         << ','
+            <<  "\"checksum\":"       << checksum                                                               << "}\n";
+}
@@ -0,0 +1,14 @@
+#pragma once                                                                  // include guard
+
+#include <chrono>                                                             // steady_clock
+#include <cstddef>                                                            // size_t
+#include <string_view>
+
+
+
+
+// Reports one benchmark measurement to standard output as a line of JSON, so every benchmark's runs can be collected together and
+// compared for regressions:
+//    {"benchmark":"find_hit","records":1000000,"operations":200000,"seconds":0.0613,"ns_per_op":306.5,"ops_per_second":3262642,"checksum":200000}
+// The checksum is whatever the measured work added up to, printed so the optimizer can't discard the work
+void report( std::string_view benchmark, std::size_t records, std::size_t operations, std::chrono::steady_clock::duration elapsed, double checksum = 0.0 );
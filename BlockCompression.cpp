@@ -0,0 +1,328 @@
+#include <algorithm>                                                          // min(), max()
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint32_t
+#include <cstring>                                                            // memcpy()
+#include <future>                                                             // async(), future
+#include <istream>
+#include <ostream>
+#include <stdexcept>                                                          // runtime_error
+#include <string>
+#include <string_view>
+#include <thread>                                                             // hardware_concurrency()
+#include <utility>                                                            // move()
+#include <vector>
+
+#include "BlockCompression.hpp"
+
+
+
+/*******************************************************************************
+**  Implementation of non-member private types, objects, and functions
+*******************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  // Each block is a series of sequences, a run of literal bytes followed by a match - a copy of earlier output:
+  //
+  //    token          1 byte    high nibble: literal length, low nibble: match length - MIN_MATCH.  A nibble of 15 means "15 plus
+  //                             the extension bytes that follow", where each extension byte of 255 means another one follows
+  //    literal length extension bytes, if any
+  //    literals
+  //    offset         2 bytes   little endian, how far back the match starts
+  //    match length extension bytes, if any
+  //
+  // The block's last sequence may end right after its literals
+  constexpr std::size_t   MIN_MATCH  = 4;
+  constexpr std::size_t   MAX_OFFSET = 65'535;
+  constexpr unsigned      HASH_BITS  = 16;
+  constexpr std::uint32_t NOT_SEEN   = 0xFFFF'FFFF;
+
+
+
+
+  [[noreturn]] void corrupt( const char * what )
+  {
+    throw std::runtime_error( std::string( "Error - Corrupt block compressed database:  " ) + what );
+  }
+
+
+
+
+  std::uint32_t load32( const char * bytes ) noexcept
+  {
+    std::uint32_t value;
+    std::memcpy( &value, bytes, sizeof( value ) );
+    return value;
+  }
+
+
+
+
+  void writeLittleEndian32( std::ostream & stream, std::uint32_t value )
+  {
+    char bytes[] = { static_cast<char>( value       ), static_cast<char>( value >>  8 ),
+                     static_cast<char>( value >> 16 ), static_cast<char>( value >> 24 ) };
+    stream.write( bytes, sizeof( bytes ) );
+  }
+
+
+
+
+  bool readLittleEndian32( std::istream & stream, std::uint32_t & value )
+  {
+    unsigned char bytes[4];
+    if( !stream.read( reinterpret_cast<char *>( bytes ), sizeof( bytes ) ) ) return false;
+    value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<std::uint32_t>( bytes[3] ) << 24;
+    return true;
+  }
+
+
+
+
+  void writeLength( std::string & out, std::size_t length )
+  {
+    for( ; length >= 255; length -= 255 ) out += static_cast<char>( 255 );
+    out += static_cast<char>( length );
+  }
+
+
+
+
+  std::size_t readLength( std::string_view in, std::size_t & position, std::size_t length )
+  {
+    if( length != 15 ) return length;
+
+    unsigned char byte;
+    do
+    {
+      if( position >= in.size() ) corrupt( "length runs past the end of the block" );
+      byte    = static_cast<unsigned char>( in[position++] );
+      length += byte;
+    } while( byte == 255 );
+    return length;
+  }
+
+
+
+
+  void writeSequence( std::string & out, std::string_view literals, std::size_t offset, std::size_t matchLength )
+  {
+    std::size_t literalNibble = std::min<std::size_t>( literals.size(), 15 );
+    std::size_t matchNibble   = matchLength == 0 ? 0 : std::min<std::size_t>( matchLength - MIN_MATCH, 15 );
+    out += static_cast<char>( literalNibble << 4 | matchNibble );
+
+    if( literalNibble == 15 ) writeLength( out, literals.size() - 15 );
+    out += literals;
+
+    if( matchLength == 0 ) return;                                            // the block's trailing literals
+    out += static_cast<char>( offset      );
+    out += static_cast<char>( offset >> 8 );
+    if( matchNibble == 15 ) writeLength( out, matchLength - MIN_MATCH - 15 );
+  }
+
+
+
+
+  // Greedy LZ77:  remember where each 4-byte sequence was last seen, and when the current position repeats one within reach, extend
+  // the match as far as it goes
+  std::string compressBlock( std::string_view in )
+  {
+    std::string                out;
+    std::vector<std::uint32_t> lastSeen( std::size_t{ 1 } << HASH_BITS, NOT_SEEN );
+    out.reserve( in.size() / 2 );
+
+    auto hash = []( std::uint32_t sequence ) { return ( sequence * 2'654'435'761U ) >> ( 32 - HASH_BITS ); };
+
+    std::size_t anchor   = 0;                                               // start of the pending literals
+    std::size_t position = 0;
+    while( position + MIN_MATCH <= in.size() )
+    {
+      std::uint32_t sequence  = load32( in.data() + position );
+      std::uint32_t & slot    = lastSeen[ hash( sequence ) ];
+      std::size_t   candidate = slot;
+      slot = static_cast<std::uint32_t>( position );
+
+      if( candidate == NOT_SEEN || position - candidate > MAX_OFFSET || load32( in.data() + candidate ) != sequence )
+      {
+        ++position;
+        continue;
+      }
+
+      std::size_t length = MIN_MATCH;
+      while( position + length < in.size() && in[candidate + length] == in[position + length] ) ++length;
+
+      writeSequence( out, in.substr( anchor, position - anchor ), position - candidate, length );
+      position += length;
+      anchor    = position;
+    }
+
+    if( anchor < in.size() ) writeSequence( out, in.substr( anchor ), 0, 0 );
+    return out;
+  }
+
+
+
+
+  std::string decompressBlock( std::string_view in, std::size_t rawSize )
+  {
+    std::string out( rawSize, '\0' );
+    char *      output   = out.data();
+    std::size_t written  = 0;
+    std::size_t position = 0;
+    while( position < in.size() )
+    {
+      std::size_t token = static_cast<unsigned char>( in[position++] );
+
+      std::size_t literals = readLength( in, position, token >> 4 );
+      if( literals > in.size() - position || literals > rawSize - written ) corrupt( "literals run past the end of the block" );
+      std::memcpy( output + written, in.data() + position, literals );
+      written  += literals;
+      position += literals;
+
+      if( position == in.size() ) break;                                      // the block's trailing literals
+
+      if( in.size() - position < 2 ) corrupt( "offset runs past the end of the block" );
+      std::size_t offset = static_cast<unsigned char>( in[position] ) | static_cast<unsigned char>( in[position + 1] ) << 8;
+      position += 2;
+
+      std::size_t length = readLength( in, position, token & 0xF ) + MIN_MATCH;
+      if( offset == 0 || offset > written ) corrupt( "match starts before the beginning of the block" );
+      if( length > rawSize - written      ) corrupt( "match runs past the end of the block" );
+
+      // A match may overlap the bytes it's producing (a run of repeated text), and then has to be copied a byte at a time
+      const char * from = output + written - offset;
+      if( offset >= length ) std::memcpy( output + written, from, length );
+      else for( std::size_t i = 0; i < length; ++i ) output[written + i] = from[i];
+      written += length;
+    }
+
+    if( written != rawSize ) corrupt( "block is shorter than its header says" );
+    return out;
+  }
+}    // unnamed, anonymous namespace
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Format detection and compression
+*******************************************************************************/
+
+// isBlockCompressed(...)
+bool isBlockCompressed( std::istream & stream )
+{
+  auto start = stream.tellg();
+
+  char magic[BLOCK_COMPRESSION_MAGIC.size()];
+  if( stream.read( magic, sizeof( magic ) ) && std::string_view( magic, sizeof( magic ) ) == BLOCK_COMPRESSION_MAGIC ) return true;
+
+  stream.clear();
+  stream.seekg( start );
+  return false;
+}
+
+
+
+
+// blockCompress(...)
+void blockCompress( std::istream & source, std::ostream & destination, std::size_t blockSize )
+{
+  destination.write( BLOCK_COMPRESSION_MAGIC.data(), static_cast<std::streamsize>( BLOCK_COMPRESSION_MAGIC.size() ) );
+
+  std::string raw( blockSize, '\0' );
+  while( source.read( raw.data(), static_cast<std::streamsize>( raw.size() ) ) || source.gcount() > 0 )
+  {
+    std::string_view block( raw.data(), static_cast<std::size_t>( source.gcount() ) );
+    std::string      compressed = compressBlock( block );
+    std::string_view payload    = compressed.size() < block.size() ? std::string_view( compressed ) : block;
+
+    writeLittleEndian32( destination, static_cast<std::uint32_t>( block  .size() ) );
+    writeLittleEndian32( destination, static_cast<std::uint32_t>( payload.size() ) );
+    destination.write( payload.data(), static_cast<std::streamsize>( payload.size() ) );
+  }
+
+  writeLittleEndian32( destination, 0 );                                      // end marker
+  writeLittleEndian32( destination, 0 );
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  BlockDecompressor
+*******************************************************************************/
+
+// BlockDecompressor(...)
+BlockDecompressor::BlockDecompressor( std::istream & compressed, std::size_t readAhead )
+  : _compressed( compressed ),
+    _readAhead ( readAhead  )
+{}
+
+
+
+
+// defaultReadAhead()
+std::size_t BlockDecompressor::defaultReadAhead() noexcept
+{
+  return std::max( 1U, std::thread::hardware_concurrency() );
+}
+
+
+
+
+// readBlock()
+bool BlockDecompressor::readBlock()
+{
+  std::uint32_t rawSize = 0, storedSize = 0;
+  if( !readLittleEndian32( _compressed, rawSize ) || !readLittleEndian32( _compressed, storedSize ) ) corrupt( "missing end marker" );
+  if( rawSize == 0 )
+  {
+    _endOfBlocks = true;
+    return false;
+  }
+  if( storedSize > rawSize ) corrupt( "block grew when compressed" );
+
+  std::string payload( storedSize, '\0' );
+  if( !_compressed.read( payload.data(), storedSize ) ) corrupt( "block is truncated" );
+
+  if( storedSize == rawSize )                                                 // stored uncompressed
+  {
+    std::promise<std::string> stored;
+    stored.set_value( std::move( payload ) );
+    _pending.push_back( stored.get_future() );
+  }
+  else
+  {
+    auto policy = _readAhead == 0 ? std::launch::deferred : std::launch::async;
+    _pending.push_back( std::async( policy, [payload = std::move( payload ), rawSize]() { return decompressBlock( payload, rawSize ); } ) );
+  }
+  return true;
+}
+
+
+
+
+// underflow()
+BlockDecompressor::int_type BlockDecompressor::underflow()
+{
+  if( gptr() < egptr() ) return traits_type::to_int_type( *gptr() );
+
+  if( _pending.empty() && !_endOfBlocks ) readBlock();
+  if( _pending.empty() ) return traits_type::eof();
+
+  _current = _pending.front().get();
+  _pending.pop_front();
+
+  // Keep the decompressors busy on the blocks that follow while the caller works through this one
+  while( !_endOfBlocks && _pending.size() < _readAhead ) readBlock();
+
+  setg( _current.data(), _current.data(), _current.data() + _current.size() );
+  return traits_type::to_int_type( *gptr() );
+}
@@ -0,0 +1,77 @@
+#pragma once                                                                  // include guard
+
+#include <cstddef>                                                            // size_t
+#include <deque>
+#include <future>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+
+
+
+// Block compressed grocery item databases
+//
+// The persistent database files are mostly repetitive quoted text, so they're stored compressed in independent blocks with a small,
+// built-in LZ77 coder (same sequence format as LZ4's block format, so it's fast to decode, but not interchangeable with .lz4
+// files).  Independent blocks let a reader decompress several at once, ahead of the parser.
+//
+//   File layout:
+//     magic                     8 bytes   "GUPCBLZ1"
+//     block...                            repeated until a block header with a raw size of zero
+//       raw size                4 bytes   little endian, the block's size once decompressed
+//       stored size             4 bytes   little endian, the size of the payload that follows.  Equal to raw size means the
+//                                         payload is stored uncompressed (it didn't shrink)
+//       payload                 stored size bytes
+//     end marker                8 bytes   zeros
+inline constexpr std::string_view BLOCK_COMPRESSION_MAGIC      = "GUPCBLZ1";
+inline constexpr std::size_t      BLOCK_COMPRESSION_BLOCK_SIZE = 1 << 20;
+
+
+// Returns true and consumes the magic if stream is positioned at the start of a block compressed file, otherwise leaves stream where
+// it was and returns false
+bool isBlockCompressed( std::istream & stream );
+
+// Writes everything read from source to destination in the block compressed format
+void blockCompress( std::istream & source, std::ostream & destination, std::size_t blockSize = BLOCK_COMPRESSION_BLOCK_SIZE );
+
+
+
+
+// A read only stream buffer that decompresses a block compressed file on the fly.  Wrap it in an std::istream and read from that
+// as if reading the plain file:
+//
+//     std::ifstream fin( "Grocery_UPC_Database-Full.datz", std::ios::binary );
+//     if( isBlockCompressed( fin ) )
+//     {
+//       BlockDecompressor decompressor( fin );
+//       std::istream      input( &decompressor );
+//       while( input >> item ) ...
+//     }
+//
+// Up to readAhead blocks are decompressed concurrently, ahead of the reader.  A readAhead of zero decompresses each block on
+// demand, in the reader's thread.
+class BlockDecompressor : public std::streambuf
+{
+  public:
+    explicit BlockDecompressor( std::istream & compressed, std::size_t readAhead = defaultReadAhead() );
+
+    BlockDecompressor            ( const BlockDecompressor & ) = delete;
+    BlockDecompressor & operator=( const BlockDecompressor & ) = delete;
+
+    static std::size_t defaultReadAhead() noexcept;                           // One block per hardware thread
+
+  protected:
+    int_type underflow() override;
+
+  private:
+    bool readBlock();                                                         // Queues the next block for decompression, false at the end
+
+    std::istream &                       _compressed;
+    std::size_t                          _readAhead;
+    bool                                 _endOfBlocks = false;
+    std::deque<std::future<std::string>> _pending;                            // blocks being decompressed, in file order
+    std::string                          _current;                            // the block being read
+};
@@ -0,0 +1,23 @@
+#include <optional>
+#include <string>
+
+#include "EmbeddedGroceryCatalog.hpp"
+#include "GroceryItem.hpp"
+#include "GroceryItemDatabase.hpp"
+#include "GroceryItemView.hpp"
+
+
+
+// find(...)
+std::optional<GroceryItemView> EmbeddedGroceryCatalog::find( const std::string & upc ) const
+{
+  if( GroceryItemView const * item = findEmbedded( upc ); item != nullptr ) return *item;
+
+  // Not one of the staples.  The runtime database is loaded the first time it's needed, so a program whose lookups all hit the
+  // catalog never pays for it.  Its items live as long as the program does, so viewing them is safe
+  if( GroceryItem * item = GroceryItemDatabase::instance().find( upc ); item != nullptr )
+  {
+    return GroceryItemView{ item->upcCode(), item->brandName(), item->productName(), item->price() };
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,111 @@
+#pragma once                                                                  // include guard
+
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint64_t, uint32_t
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "GroceryItemView.hpp"
+
+
+
+
+// A grocery item catalog compiled into the program
+//
+// For a fixed set of items - a kiosk's few thousand staples, say - GroceryCatalogEmbedder turns a database file into a header of
+// constexpr tables:  the items themselves, placed by a minimal perfect hash, and the hash's displacements.  Including that header
+// defines an EmbeddedGroceryCatalog over them, so looking up an embedded item costs two hashes and one string comparison, with no
+// startup time, no file, and no allocation.  The build step, which CMakeLists.txt runs for GroceryKioskPriceCheck:
+//
+//     GroceryCatalogEmbedder Kiosk_Staples.dat EmbeddedGroceryCatalogData.hpp
+//
+// and then, in the program:
+//
+//     #include "EmbeddedGroceryCatalogData.hpp"
+//     if( auto item = EMBEDDED_GROCERY_CATALOG.find( upc ) ) ...                 // falls back to GroceryItemDatabase on a miss
+//
+// The perfect hash is "hash and displace":  each UPC hashes to one of displacements.size() buckets, and the bucket's displacement
+// is the seed that sends every UPC in it to its own slot.
+class EmbeddedGroceryCatalog
+{
+  public:
+    constexpr EmbeddedGroceryCatalog( std::span<GroceryItemView const> slots, std::span<std::uint32_t const> displacements ) noexcept
+      : _slots( slots ), _displacements( displacements )
+    {}
+
+    // Locate a particular record
+    constexpr GroceryItemView const * findEmbedded( std::string_view upc ) const noexcept;   // Returns nullptr if not embedded
+    std::optional<GroceryItemView>    find        ( const std::string & upc ) const;         // Looks in the catalog first, then in
+                                                                              // GroceryItemDatabase::instance().  Returns nullopt if in neither
+
+    // Queries
+    constexpr std::size_t size() const noexcept { return _slots.size(); }     // Returns the number of items embedded
+
+    constexpr bool isPerfect() const noexcept;                                // Returns true if every embedded item is found in its slot.
+                                                                              // Generated headers static_assert it
+
+    // The hash the embedder and the catalog share.  FNV-1a, seeded, and finished with a 64-bit mixer so nearby seeds give unrelated
+    // hashes
+    static constexpr std::uint64_t hash( std::string_view upc, std::uint64_t seed ) noexcept;
+
+  private:
+    std::span<GroceryItemView const> _slots;
+    std::span<std::uint32_t const>   _displacements;
+};
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Inline implementations
+*******************************************************************************/
+
+// hash(...)
+constexpr std::uint64_t EmbeddedGroceryCatalog::hash( std::string_view upc, std::uint64_t seed ) noexcept
+{
+  std::uint64_t value = 0xCBF2'9CE4'8422'2325ULL ^ ( seed * 0x9E37'79B9'7F4A'7C15ULL );
+  for( char digit : upc )
+  {
+    value ^= static_cast<unsigned char>( digit );
+    value *= 0x0000'0100'0000'01B3ULL;
+  }
+
+  value ^= value >> 33;
+  value *= 0xFF51'AFD7'ED55'8CCDULL;
+  value ^= value >> 33;
+  value *= 0xC4CE'B9FE'1A85'EC53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+
+
+
+// findEmbedded(...)
+constexpr GroceryItemView const * EmbeddedGroceryCatalog::findEmbedded( std::string_view upc ) const noexcept
+{
+  if( _slots.empty() || _displacements.empty() ) return nullptr;
+
+  std::uint32_t           displacement = _displacements[ hash( upc, 0 ) % _displacements.size() ];
+  GroceryItemView const & slot         = _slots[ hash( upc, displacement ) % _slots.size() ];
+  return slot.upcCode == upc ? &slot : nullptr;
+}
+
+
+
+
+// isPerfect()
+constexpr bool EmbeddedGroceryCatalog::isPerfect() const noexcept
+{
+  for( auto && item : _slots )
+  {
+    if( findEmbedded( item.upcCode ) != &item ) return false;
+  }
+  return true;
+}
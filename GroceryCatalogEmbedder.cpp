@@ -0,0 +1,220 @@
+#include <algorithm>                                                                      // sort(), all_of()
+#include <charconv>                                                                       // to_chars()
+#include <cstddef>                                                                        // size_t
+#include <cstdint>                                                                        // uint32_t
+#include <exception>                                                                      // exception
+#include <filesystem>                                                                     // path
+#include <fstream>                                                                        // ifstream, ofstream
+#include <iostream>                                                                       // cout, cerr
+#include <optional>
+#include <stdexcept>                                                                      // runtime_error
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BlockCompression.hpp"
+#include "EmbeddedGroceryCatalog.hpp"
+#include "GroceryItem.hpp"
+#include "GroceryItemDatabase.hpp"
+
+
+
+namespace
+{
+  constexpr std::uint32_t MAX_DISPLACEMENT = 100'000'000;                                 // far more than any bucket needs in practice
+
+
+
+  // Spell text as a C++ string literal.  Anything that isn't printable ASCII is written as a three digit octal escape, which can't
+  // run into the character after it
+  std::string literal( std::string_view text )
+  {
+    static constexpr char OCTAL[] = "01234567";
+
+    std::string result = "\"";
+    for( unsigned char c : text )
+    {
+      if     ( c == '"' || c == '\\' )  { result += '\\';  result += static_cast<char>( c ); }
+      else if( c >= 0x20 && c < 0x7F )  result += static_cast<char>( c );
+      else                              { result += '\\';  result += OCTAL[c >> 6];  result += OCTAL[( c >> 3 ) & 7];  result += OCTAL[c & 7]; }
+    }
+    return result += '"';
+  }
+
+
+
+  // The shortest spelling that reads back as exactly the same double
+  std::string literal( double value )
+  {
+    char buffer[32];
+    auto [end, error] = std::to_chars( buffer, buffer + sizeof( buffer ), value );
+    std::string result( buffer, end );
+    if( result.find_first_of( ".einf" ) == std::string::npos ) result += ".0";
+    return result;
+  }
+
+
+
+  bool isIdentifier( std::string_view name )
+  {
+    auto isWordCharacter = []( char c ) { return ( c >= 'A' && c <= 'Z' ) || ( c >= 'a' && c <= 'z' ) || ( c >= '0' && c <= '9' ) || c == '_'; };
+    return !name.empty() && !( name.front() >= '0' && name.front() <= '9' ) && std::all_of( name.begin(), name.end(), isWordCharacter );
+  }
+
+
+
+  // Places items in slots by a minimal perfect hash (see EmbeddedGroceryCatalog.hpp) and returns the buckets' displacements.
+  // Buckets are placed largest first, while there's the most room, each with the first displacement that sends all of its UPCs to
+  // distinct free slots
+  std::vector<std::uint32_t> placeItems( std::vector<GroceryItem> const & items, std::vector<GroceryItem const *> & slots )
+  {
+    std::size_t bucketCount = ( items.size() + 3 ) / 4;                                   // about four UPCs per bucket
+
+    std::vector<std::vector<GroceryItem const *>> buckets( bucketCount );
+    for( auto && item : items ) buckets[ EmbeddedGroceryCatalog::hash( item.upcCode(), 0 ) % bucketCount ].push_back( &item );
+
+    std::vector<std::size_t> order( bucketCount );
+    for( std::size_t bucket = 0; bucket < bucketCount; ++bucket ) order[bucket] = bucket;
+    std::sort( order.begin(), order.end(), [&]( std::size_t lhs, std::size_t rhs ) { return buckets[lhs].size() > buckets[rhs].size(); } );
+
+    std::vector<std::uint32_t> displacements( bucketCount, 0 );
+    std::vector<std::size_t>   chosen;
+    slots.assign( items.size(), nullptr );
+    for( std::size_t bucket : order )
+    {
+      if( buckets[bucket].empty() ) break;                                                // the rest are empty too
+
+      for( std::uint32_t displacement = 1; ; ++displacement )
+      {
+        if( displacement > MAX_DISPLACEMENT ) throw std::runtime_error( "Error - Could not find a perfect hash for the catalog" );
+
+        chosen.clear();
+        for( auto && item : buckets[bucket] )
+        {
+          std::size_t slot = EmbeddedGroceryCatalog::hash( item->upcCode(), displacement ) % slots.size();
+          if( slots[slot] != nullptr || std::find( chosen.begin(), chosen.end(), slot ) != chosen.end() ) break;
+          chosen.push_back( slot );
+        }
+        if( chosen.size() < buckets[bucket].size() ) continue;
+
+        for( std::size_t i = 0; i < chosen.size(); ++i ) slots[ chosen[i] ] = buckets[bucket][i];
+        displacements[bucket] = displacement;
+        break;
+      }
+    }
+    return displacements;
+  }
+}    // namespace
+
+
+
+
+// main()
+//    GroceryCatalogEmbedder source.dat destination.hpp [name]
+//
+// The build step for an EmbeddedGroceryCatalog (see EmbeddedGroceryCatalog.hpp):  writes a header that defines a constexpr catalog,
+// called name (EMBEDDED_GROCERY_CATALOG by default), of every item in the source database - plain or block compressed.  When a UPC
+// appears more than once the one GroceryItemDatabase::find() would return is kept, chosen by the same GROCERY_DB_DUPLICATE_POLICY
+// and listed in the same GROCERY_DB_DUPLICATE_REPORT (see GroceryItemDatabase.hpp).  The source is parsed by the loader's own
+// GroceryItemDatabase::readItems(), so the two accept the same files, but here a malformed record is an error rather than skipped.
+//    Ex:  GroceryCatalogEmbedder Kiosk_Staples.dat EmbeddedGroceryCatalogData.hpp
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    std::string name = argc >= 4 ? argv[3] : "EMBEDDED_GROCERY_CATALOG";
+    if( argc < 3 || !isIdentifier( name ) )
+    {
+      std::cerr << "Usage:  " << argv[0] << " source.dat destination.hpp [name]\n"
+                << "        name must be a C++ identifier, and defaults to EMBEDDED_GROCERY_CATALOG\n";
+      return 2;
+    }
+
+    std::ifstream source( argv[1], std::ios::binary );
+    if( !source.is_open() )
+    {
+      std::cerr << "Error:  Could not open \"" << argv[1] << "\"\n";
+      return 1;
+    }
+
+    std::optional<BlockDecompressor> decompressor;
+    std::istream                     input( source.rdbuf() );
+    if( isBlockCompressed( source ) ) input.rdbuf( &decompressor.emplace( source ) );
+
+    std::vector<GroceryItem> items;
+    if( std::size_t malformed = GroceryItemDatabase::readItems( input, items );  malformed > 0 || input.bad() )
+    {
+      std::cerr << "Error:  \"" << argv[1] << "\" has " << malformed << " malformed records" << ( input.bad() ? " and is corrupt" : "" ) << '\n';
+      return 1;
+    }
+
+    GroceryItemDatabase::resolveDuplicates( items, '"' + std::string( argv[1] ) + '"' );
+    if( items.empty() )
+    {
+      std::cerr << "Error:  \"" << argv[1] << "\" has no items to embed\n";
+      return 1;
+    }
+
+    std::vector<GroceryItem const *> slots;
+    std::vector<std::uint32_t>       displacements = placeItems( items, slots );
+
+
+    std::ofstream destination( argv[2], std::ios::trunc );
+    if( !destination.is_open() )
+    {
+      std::cerr << "Error:  Could not create \"" << argv[2] << "\"\n";
+      return 1;
+    }
+
+    std::string sourceName = std::filesystem::path( argv[1] ).filename().string();
+    destination << "// Generated by GroceryCatalogEmbedder from " << literal( sourceName ) << ".  Don't edit it, regenerate it:\n"
+                << "//    GroceryCatalogEmbedder " << sourceName << ' ' << std::filesystem::path( argv[2] ).filename().string() << ' ' << name << "\n"
+                << "#pragma once\n"
+                << "\n"
+                << "#include <cstdint>\n"
+                << "\n"
+                << "#include \"EmbeddedGroceryCatalog.hpp\"\n"
+                << "#include \"GroceryItemView.hpp\"\n"
+                << "\n"
+                << "\n"
+                << "\n"
+                << "\n"
+                << "// " << items.size() << " items, in perfect hash order\n"
+                << "inline constexpr GroceryItemView " << name << "_SLOTS[] =\n"
+                << "{\n";
+    for( auto && item : slots )
+    {
+      destination << "  { " << literal( item->upcCode() ) << ", " << literal( item->brandName() ) << ", " << literal( item->productName() )
+                  << ", " << literal( item->price() ) << " },\n";
+    }
+    destination << "};\n"
+                << "\n"
+                << "inline constexpr std::uint32_t " << name << "_DISPLACEMENTS[] =\n"
+                << "{";
+    for( std::size_t bucket = 0; bucket < displacements.size(); ++bucket )
+    {
+      destination << ( bucket % 16 == 0 ? "\n  " : " " ) << displacements[bucket] << ',';
+    }
+    destination << "\n"
+                << "};\n"
+                << "\n"
+                << "inline constexpr EmbeddedGroceryCatalog " << name << "( " << name << "_SLOTS, " << name << "_DISPLACEMENTS );\n"
+                << "static_assert( " << name << ".isPerfect(), \"" << name << " is out of date with EmbeddedGroceryCatalog::hash().  Regenerate it\" );\n";
+
+    destination.close();
+    if( !destination )
+    {
+      std::cerr << "Error:  Could not write \"" << argv[2] << "\"\n";
+      return 1;
+    }
+
+    std::cout << "Embedded " << items.size() << " grocery items in " << displacements.size() << " buckets as " << name << " in " << argv[2] << '\n';
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include <cstdlib>                                                                        // strtoull()
+#include <exception>                                                                      // exception
+#include <filesystem>                                                                     // file_size()
+#include <fstream>                                                                        // ifstream, ofstream
+#include <iostream>                                                                       // cout, cerr
+#include <string>
+
+#include "BlockCompression.hpp"
+
+
+
+// main()
+//    GroceryDatabaseCompressor source.dat destination.datz [blockSize]
+//
+// Writes a block compressed copy of a grocery item database.  GroceryItemDatabase finds and reads the .datz files directly.
+//    Ex:  GroceryDatabaseCompressor Grocery_UPC_Database-Full.dat Grocery_UPC_Database-Full.datz
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    if( argc < 3 )
+    {
+      std::cerr << "Usage:  " << argv[0] << " source.dat destination.datz [blockSize]\n";
+      return 2;
+    }
+
+    std::size_t blockSize = argc >= 4 ? std::strtoull( argv[3], nullptr, 10 ) : BLOCK_COMPRESSION_BLOCK_SIZE;
+    if( blockSize == 0 || blockSize > 0xFFFF'FFFF )
+    {
+      std::cerr << "Error:  Block size must be between 1 and 4294967295 bytes\n";
+      return 2;
+    }
+
+    std::ifstream source( argv[1], std::ios::binary );
+    if( !source.is_open() )
+    {
+      std::cerr << "Error:  Could not open \"" << argv[1] << "\"\n";
+      return 1;
+    }
+
+    std::ofstream destination( argv[2], std::ios::binary | std::ios::trunc );
+    if( !destination.is_open() )
+    {
+      std::cerr << "Error:  Could not create \"" << argv[2] << "\"\n";
+      return 1;
+    }
+
+    blockCompress( source, destination, blockSize );
+    destination.close();
+    if( !destination )
+    {
+      std::cerr << "Error:  Could not write \"" << argv[2] << "\"\n";
+      return 1;
+    }
+
+    auto before = std::filesystem::file_size( argv[1] );
+    auto after  = std::filesystem::file_size( argv[2] );
+    std::cout << argv[1] << ":  " << before << " bytes -> " << after << " bytes, ratio "
+              << ( after == 0 ? 0.0 : static_cast<double>( before ) / static_cast<double>( after ) ) << '\n';
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
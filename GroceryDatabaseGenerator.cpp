@@ -0,0 +1,204 @@
+#include <array>                                                                          // array
+#include <cstddef>                                                                        // size_t
+#include <cstdint>                                                                        // uint64_t
+#include <cstdlib>                                                                        // strtoull(), strtod()
+#include <exception>                                                                      // exception
+#include <fstream>                                                                        // ofstream
+#include <iostream>                                                                       // cout, cerr
+#include <random>                                                                         // mt19937_64, uniform_int_distribution, uniform_real_distribution
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "GroceryItem.hpp"
+
+
+
+namespace
+{
+  constexpr std::array BRAND_WORDS   = { "Kellogg's", "Morton", "Nature's", "Smart", "Kirkland", "Fiber", "Applegate", "Great", "Campbell's", "Heinz",
+                                         "Boston", "Del", "Kraft", "General", "Hormel", "Pepperidge", "Betty", "Progresso", "Ocean", "Market",
+                                         "Farms", "Way", "Living", "Promise", "Value", "Mills", "Crocker", "Spray", "Pantry", "Harvest" };
+
+  constexpr std::array PRODUCT_WORDS = { "Organic", "Natural", "Whole", "Grain", "Cereal", "Soup", "Chicken", "Noodle", "Tomato", "Ketchup",
+                                         "Salt", "Coarse", "Kosher", "Bread", "Country", "White", "Wheat", "Milk", "Lowfat", "Eggs",
+                                         "Large", "Brown", "Rice", "Krispies", "Beans", "Black", "Sauce", "Pasta", "Spaghetti", "Meatballs",
+                                         "Crackers", "Cookies", "Chocolate", "Chip", "Vanilla", "Juice", "Apple", "Orange", "Yogurt", "Greek",
+                                         "Cheddar", "Butter", "Unsalted", "Coffee", "Roast", "Tea", "Green", "Snack", "Bars", "Protein",
+                                         "Notebook", "College", "Ruled", "Subject", "Forskohlii", "Omega", "Family", "Dairy", "Pure", "Sea" };
+
+
+
+  // The last digit of a UPC/GTIN is a check digit:  weight the other digits 3, 1, 3, 1, ... from the right, and the check digit
+  // brings the weighted sum up to a multiple of 10
+  char checkDigit( std::string_view digits )
+  {
+    unsigned sum    = 0;
+    unsigned weight = 3;
+    for( auto digit = digits.rbegin(); digit != digits.rend(); ++digit, weight = 4 - weight ) sum += weight * static_cast<unsigned>( *digit - '0' );
+    return static_cast<char>( '0' + ( 10 - sum % 10 ) % 10 );
+  }
+
+
+
+  struct Manufacturer
+  {
+    std::string   prefix;                                                                 // the leading UPC digits identifying the manufacturer
+    std::string   brandName;
+    std::uint64_t itemNumbers = 0;                                                        // how many item numbers fit after the prefix
+    std::uint64_t firstItem   = 0;                                                        // where this manufacturer's item numbers start, and
+    std::uint64_t stride      = 1;                                                        // the step between them (see next())
+    std::uint64_t items       = 0;                                                        // how many have been handed out
+  };
+
+
+
+  class Generator
+  {
+    public:
+      Generator( std::size_t records, std::uint64_t seed, double duplicateFraction = 0.0 )
+        : _random( seed ),
+          _duplicateFraction( duplicateFraction )
+      {
+        // Real databases have a long tail of manufacturers, each with many products under one prefix.  No company prefix may be the
+        // start of another's, else "1234567" + "8901" and "12345678" + "901" would be the same UPC
+        std::size_t                     manufacturers = records / 40 + 1;
+        std::unordered_set<std::string> prefixes, leadingParts;
+        while( _manufacturers.size() < manufacturers )
+        {
+          std::string prefix = digits( 6 + _random() % 3 );                               // 6 to 8-digit company prefixes
+          bool        clash  = prefixes.contains( prefix ) || leadingParts.contains( prefix );
+          for( std::size_t length = 6; length < prefix.size() && !clash; ++length ) clash = prefixes.contains( prefix.substr( 0, length ) );
+          if( clash ) continue;
+
+          prefixes.insert( prefix );
+          for( std::size_t length = 6; length < prefix.size(); ++length ) leadingParts.insert( prefix.substr( 0, length ) );
+
+          std::string brand( pick( BRAND_WORDS ) );
+          if( coinFlip( 0.6 ) ) brand += ' ' + std::string( pick( BRAND_WORDS ) );
+
+          Manufacturer & manufacturer = _manufacturers.emplace_back( Manufacturer{ std::move( prefix ), std::move( brand ) } );
+          manufacturer.itemNumbers = 1;
+          for( std::size_t i = manufacturer.prefix.size(); i < 11; ++i ) manufacturer.itemNumbers *= 10;
+          manufacturer.firstItem = _random() % manufacturer.itemNumbers;
+          do manufacturer.stride = 1 + _random() % manufacturer.itemNumbers; while( manufacturer.stride % 2 == 0 || manufacturer.stride % 5 == 0 );
+        }
+      }
+
+      GroceryItem next()
+      {
+        // Merged vendor feeds list the same product more than once, usually at different prices.  Repeat a recent item with a new price
+        if( !_recent.empty() && coinFlip( _duplicateFraction ) )
+        {
+          GroceryItem const & earlier = _recent[ _random() % _recent.size() ];
+          return GroceryItem( earlier.productName(), earlier.brandName(), earlier.upcCode(), randomPrice() );
+        }
+
+        // A manufacturer whose item numbers have all been used can't introduce another product.  There are about 40 products per
+        // manufacturer, and room for at least a thousand, so this rarely takes a second pick
+        Manufacturer * manufacturer = nullptr;
+        do manufacturer = &_manufacturers[ _random() % _manufacturers.size() ]; while( manufacturer->items == manufacturer->itemNumbers );
+
+        // Every new product gets its own item number:  stepping through them by a stride with no factor in common with their count (a
+        // power of 10) visits each exactly once, in a scattered order
+        std::string itemNumber = std::to_string( ( manufacturer->firstItem + manufacturer->items++ * manufacturer->stride ) % manufacturer->itemNumbers );
+        itemNumber.insert( 0, 11 - manufacturer->prefix.size() - itemNumber.size(), '0' );
+
+        // 12-digit UPC-A codes, and 14-digit GTINs (zero padded UPC-A codes most of the time)
+        std::string upc = manufacturer->prefix + itemNumber;
+        upc += checkDigit( upc );
+        if( coinFlip( 0.75 ) ) upc = ( coinFlip( 0.9 ) ? "00" : digits( 2 ) ) + upc;
+
+        // Product names repeat the brand, run from a couple of words to a couple hundred characters, and sometimes contain quotes and
+        // backslashes that have to be escaped (Ex:  Smart Living 10.5" X 8" 3 Subject Notebook College Ruled)
+        std::string name = manufacturer->brandName;
+        std::size_t words = coinFlip( 0.05 ) ? 20 + _random() % 20 : 2 + _random() % 6;
+        for( std::size_t i = 0; i < words; ++i ) name += ' ' + std::string( pick( PRODUCT_WORDS ) );
+        if( coinFlip( 0.10 ) ) name += ' ' + std::to_string( 1 + _random() % 20 ) + '.' + std::to_string( _random() % 10 ) + "\" X " + std::to_string( 1 + _random() % 12 ) + '"';
+        if( coinFlip( 0.01 ) ) name += " 1\\2 Gallon";
+        if( coinFlip( 0.30 ) ) name += " - " + std::to_string( 1 + _random() % 100 ) + " Ct";
+
+        GroceryItem item( std::move( name ), manufacturer->brandName, std::move( upc ), randomPrice() );
+        if( _duplicateFraction > 0.0 )
+        {
+          if( _recent.size() < RECENT ) _recent.push_back( item );
+          else                          _recent[ _random() % RECENT ] = item;
+        }
+        return item;
+      }
+
+    private:
+      template<typename Words>
+      std::string_view pick( Words const & words ) { return words[ _random() % words.size() ]; }
+
+      double randomPrice() { return static_cast<double>( std::uniform_int_distribution<int>( 49, 9'999 )( _random ) ) / 100.0; }
+
+      bool coinFlip( double probability ) { return std::uniform_real_distribution<double>( 0.0, 1.0 )( _random ) < probability; }
+
+      std::string digits( std::size_t count )
+      {
+        std::string result;
+        for( std::size_t i = 0; i < count; ++i ) result += static_cast<char>( '0' + _random() % 10 );
+        return result;
+      }
+
+      static constexpr std::size_t RECENT = 64 * 1024;                                    // items a duplicate may repeat
+
+      std::mt19937_64           _random;
+      double                    _duplicateFraction;
+      std::vector<Manufacturer> _manufacturers;
+      std::vector<GroceryItem>  _recent;
+  };
+}    // namespace
+
+
+
+
+// main()
+//    GroceryDatabaseGenerator records destination.dat [seed [duplicateFraction]]
+//
+// Writes a synthetic grocery item database of the given size, in exactly the format GroceryItem's extraction operator reads (the
+// records are written with its insertion operator).  The same seed always produces the same database.  Every record has its own UPC
+// except for about duplicateFraction of them (0 by default), which repeat the UPC, brand, and product name of an earlier record at
+// a different price, like a merged vendor feed.
+//    Ex:  GroceryDatabaseGenerator 50000000 Grocery_UPC_Database-Full.dat
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    if( argc < 3 )
+    {
+      std::cerr << "Usage:  " << argv[0] << " records destination.dat [seed [duplicateFraction]]\n";
+      return 2;
+    }
+
+    std::size_t   records           = std::strtoull( argv[1], nullptr, 10 );
+    std::uint64_t seed              = argc >= 4 ? std::strtoull( argv[3], nullptr, 10 ) : 20240229;
+    double        duplicateFraction = argc >= 5 ? std::strtod  ( argv[4], nullptr     ) : 0.0;
+
+    std::ofstream destination( argv[2], std::ios::binary | std::ios::trunc );
+    if( !destination.is_open() )
+    {
+      std::cerr << "Error:  Could not create \"" << argv[2] << "\"\n";
+      return 1;
+    }
+
+    Generator generator( records, seed, duplicateFraction );
+    for( std::size_t i = 0; i < records; ++i ) destination << generator.next() << '\n';
+
+    destination.close();
+    if( !destination )
+    {
+      std::cerr << "Error:  Could not write \"" << argv[2] << "\"\n";
+      return 1;
+    }
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
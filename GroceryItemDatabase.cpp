@@ -1,15 +1,69 @@
 ///////////////////////// TO-DO (1) //////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
 #include <fstream>
 #include <stdexcept>
 #include <iostream>
 #include <iterator>
+#include <mutex>
+#include <optional>
 #include <utility>
 #include <filesystem>
+#include <functional>
+#include <span>
+#include <spanstream>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "AsyncFileReader.hpp"
+#include "BlockCompression.hpp"
 #include "GroceryItemDatabase.hpp"
 /////////////////////// END-TO-DO (1) ////////////////////////////
 
 
 
+namespace
+{
+  // Sorts values with every hardware thread:  each sorts an equal share, then neighboring shares are merged pairwise, in parallel,
+  // until one run remains.  Small inputs aren't worth the threads and are sorted in place.  (std::sort( std::execution::par, ...)
+  // would need Intel TBB linked in with libstdc++.)
+  template<typename T, typename Less>
+  void parallelSort( std::vector<T> & values, Less less )
+  {
+    constexpr std::size_t MIN_SHARE = 64 * 1024;
+
+    std::size_t threads = std::min<std::size_t>( std::max( 1u, std::thread::hardware_concurrency() ), values.size() / MIN_SHARE );
+    if( threads <= 1 )
+    {
+      std::sort( values.begin(), values.end(), less );
+      return;
+    }
+
+    std::vector<std::size_t> bounds( threads + 1 );
+    for( std::size_t share = 0; share <= threads; ++share ) bounds[share] = values.size() * share / threads;
+    auto at = [&]( std::size_t share ) { return values.begin() + static_cast<std::ptrdiff_t>( bounds[ std::min( share, threads ) ] ); };
+
+    {
+      std::vector<std::jthread> workers;
+      for( std::size_t share = 0; share < threads; ++share ) workers.emplace_back( [&, share] { std::sort( at( share ), at( share + 1 ), less ); } );
+    }
+
+    for( std::size_t width = 1; width < threads; width *= 2 )
+    {
+      std::vector<std::jthread> workers;
+      for( std::size_t share = 0; share + width < threads; share += 2 * width )
+      {
+        workers.emplace_back( [&, share, width] { std::inplace_merge( at( share ), at( share + width ), at( share + 2 * width ), less ); } );
+      }
+    }
+  }
+}
+
+
+
+
 // Return a reference to the one and only instance of the database
 GroceryItemDatabase & GroceryItemDatabase::instance()
 {
@@ -20,13 +74,40 @@ GroceryItemDatabase & GroceryItemDatabase::instance()
   {
     std::string filename;
 
-    // Look for a prioritized list of database files in the current working directory to use
+    // A database named explicitly in the environment takes priority over the search below.  This lets benchmarks and store servers
+    // point at a file outside the current working directory.  Ex:  GROCERY_UPC_DATABASE=/srv/pos/Grocery_UPC_Database-Full.datz
+    if( const char * named = std::getenv( "GROCERY_UPC_DATABASE" );  named != nullptr && *named != '\0' ) return filename = named;
+
+    // Look for a prioritized list of database files in the current working directory to use.  A block compressed copy (.datz, see
+    // BlockCompression.hpp) is preferred over the plain file with the same contents - it's a fraction of the size to read from disk -
+    // but only while it's current.  One older than its plain file predates the plain file's last change (the store updated the
+    // .dat and didn't recompress it), so the plain file is read instead, with a warning.
     // Don't forget to #include <filesystem> to get visibility to the exists() function
-    if     ( filename = "Grocery_UPC_Database-Full.dat"  ;   std::filesystem::exists( filename ) ) /* intentionally empty*/ ;
-    else if( filename = "Grocery_UPC_Database-Large.dat" ;   std::filesystem::exists( filename ) ) /* intentionally empty*/ ;
-    else if( filename = "Grocery_UPC_Database-Medium.dat";   std::filesystem::exists( filename ) ) /* intentionally empty*/ ;
-    else if( filename = "Grocery_UPC_Database-Small.dat" ;   std::filesystem::exists( filename ) ) /* intentionally empty*/ ;
-    else if( filename = "Sample_GroceryItem_Database.dat";   std::filesystem::exists( filename ) ) /* intentionally empty*/ ;
+    auto pick = [&filename]( std::string const & name )
+    {
+      std::string     compressed = name + ".datz";
+      std::string     plain      = name + ".dat";
+      std::error_code error;
+      bool            useCompressed = std::filesystem::exists( compressed, error );
+      bool            usePlain      = std::filesystem::exists( plain,      error );
+
+      if( useCompressed && usePlain && std::filesystem::last_write_time( compressed, error ) < std::filesystem::last_write_time( plain, error ) )
+      {
+        std::cerr << "Warning:  \"" << compressed << "\" is older than \"" << plain << "\", so it may be stale.  Reading \"" << plain
+                  << "\" instead.  Recompress it with GroceryDatabaseCompressor\n\n";
+        useCompressed = false;
+      }
+
+      if     ( useCompressed ) filename = compressed;
+      else if( usePlain      ) filename = plain;
+      return useCompressed || usePlain;
+    };
+
+    if     ( pick( "Grocery_UPC_Database-Full"   ) ) /* intentionally empty*/ ;
+    else if( pick( "Grocery_UPC_Database-Large"  ) ) /* intentionally empty*/ ;
+    else if( pick( "Grocery_UPC_Database-Medium" ) ) /* intentionally empty*/ ;
+    else if( pick( "Grocery_UPC_Database-Small"  ) ) /* intentionally empty*/ ;
+    else if( pick( "Sample_GroceryItem_Database" ) ) /* intentionally empty*/ ;
     else     filename.clear();
 
     return filename;
@@ -42,8 +123,34 @@ GroceryItemDatabase & GroceryItemDatabase::instance()
 // Construction
 GroceryItemDatabase::GroceryItemDatabase( const std::string & filename )
 {
-  std::ifstream fin( filename, std::ios::binary );
-  if( !fin.is_open() ) std::cerr << "Warning:  Could not open persistent grocery item database file \"" << filename << "\".  Proceeding with empty database\n\n";
+  auto loadStart = std::chrono::steady_clock::now();
+
+  // The file is read with large asynchronous reads, a few chunks ahead of the parser (see AsyncFileReader.hpp).  GROCERY_DB_LOADER
+  // picks the reads' backend - "io_uring" or "thread" - or "ifstream" to read synchronously through a plain file buffer instead,
+  // for comparison.  By default io_uring is used when the kernel allows it
+  const char *                   loaderName = std::getenv( "GROCERY_DB_LOADER" );
+  std::string_view               loader     = loaderName != nullptr ? loaderName : "";
+  std::filebuf                   plainFile;
+  std::optional<AsyncFileReader> asyncFile;
+  std::istream                   fin( nullptr );
+  if( loader == "ifstream" )
+  {
+    plainFile.open( filename, std::ios::in | std::ios::binary );
+    fin.rdbuf( &plainFile );
+  }
+  else
+  {
+    auto backend = loader == "io_uring" ? AsyncFileReader::Backend::IoUring
+                 : loader == "thread"   ? AsyncFileReader::Backend::ReadAheadThread
+                 :                        AsyncFileReader::Backend::Automatic;
+    fin.rdbuf( &asyncFile.emplace( filename, backend ) );
+  }
+
+  if( !plainFile.is_open() && !( asyncFile && asyncFile->is_open() ) )
+  {
+    _counters.recordOpenFailure();
+    std::cerr << "Warning:  Could not open persistent grocery item database file \"" << filename << "\".  Proceeding with empty database\n\n";
+  }
 
   // The file contains GroceryItems separated by whitespace.  A GroceryItem has 4 pieces of data delimited with a comma.  (This
   // exactly matches the previous assignment as to how GroceryItems are read)
@@ -61,23 +168,254 @@ GroceryItemDatabase::GroceryItemDatabase( const std::string & filename )
   //
   //  Note: double quotes within the string are escaped with the backslash character
   //
+  //  A record may wrap onto following lines.  A malformed record is skipped, along with the rest of the text up to the next line
+  //  that starts with a double quote, where the next record is taken to begin (see readItems())
+  //
+
+  // A block compressed file is recognized by its leading magic and decompressed on the fly (several blocks at once, ahead of the
+  // parser) straight into the same extraction loop as a plain file
+  static_assert( AsyncFileReader::MIN_CHUNK_SIZE >= BLOCK_COMPRESSION_MAGIC.size(), "isBlockCompressed() must be able to seek back over the magic" );
+  std::optional<BlockDecompressor> decompressor;
+  std::istream                     input( fin.rdbuf() );
+  if( isBlockCompressed( fin ) ) input.rdbuf( &decompressor.emplace( fin ) );
 
   ///////////////////////// TO-DO (2) //////////////////////////////
-  GroceryItem item;
-  while( fin >> item )
+  std::size_t malformed = readItems( input, _data );
+  _counters.recordParseFailures( malformed );
+  /////////////////////// END-TO-DO (2) ////////////////////////////
+
+  if( malformed   > 0 ) std::cerr << "Warning:  Skipped " << malformed << " malformed records in persistent grocery item database file \"" << filename << "\"\n\n";
+  if( input.bad()     ) std::cerr << "Warning:  Persistent grocery item database file \"" << filename << "\" is corrupt.  Proceeding with the " << _data.size() << " items read before the damage\n\n";
+
+  // The UPC is the primary key.  Resolve records sharing one by the configured policy (see DuplicatePolicy) and report them
+  std::vector<UpcIndex::Key> keys;
+  Duplicates duplicates = resolveDuplicates( _data, "persistent grocery item database file \"" + filename + '"', &keys );
+  _counters.recordDuplicates( duplicates.upcs, duplicates.dropped );
+  _index = keys.empty() ? UpcIndex{} : UpcIndex( keys );
+
+  _counters.recordLoad( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - loadStart ), _data.size(), _index.depth() );
+
+  // Note:  The file is intentionally not explicitly closed.  The file is closed when its buffer goes out of scope - for whatever
+  //        reason.  More precisely, the objects named "plainFile" and "asyncFile" are destroyed when they go out of scope and the
+  //        file is closed in the destructor. See RAII
+}
+
+
+
+
+
+
+
+
+
+// readItems(...)
+// Records are parsed from a buffer of whole lines rather than straight from the stream, so a malformed record can be skipped to
+// the next line that starts a record:  by the time extraction fails, std::quoted and the delimiters may already have read past
+// the newline into the next record, which the stream couldn't give back.  A record still incomplete at the end of the buffer is
+// kept, and the next line appended, until it has MAX_RECORD_LINES lines.  (A span stream parses the buffer in place.)
+std::size_t GroceryItemDatabase::readItems( std::istream & input, std::vector<GroceryItem> & items )
+{
+  constexpr std::size_t MAX_RECORD_LINES = 8;                                   // a record wrapped further is taken to be malformed
+
+  std::string      pending;                                                     // lines read but not yet parsed
+  std::string      line;
+  std::ispanstream record( std::span<char const>{} );
+  std::size_t      malformed = 0;
+
+  auto parsePending = [&]( bool endOfInput )
+  {
+    std::size_t parsed = 0;
+    while( true )
+    {
+      record.span( std::span<char const>( pending.data() + parsed, pending.size() - parsed ) );
+      record.clear();
+      if( ( record >> std::ws ).eof() ) { parsed = pending.size();  break; }
+
+      std::size_t start = parsed + static_cast<std::size_t>( record.tellg() );
+      if( GroceryItem item;  record >> item )
+      {
+        items.push_back( std::move( item ) );
+        parsed += static_cast<std::size_t>( record.tellg() );
+        continue;
+      }
+
+      // Ran out of text partway through the record?  Then it may continue on the next line
+      auto lines = static_cast<std::size_t>( std::count( pending.begin() + static_cast<std::ptrdiff_t>( start ), pending.end(), '\n' ) );
+      if( record.eof() && !endOfInput && lines < MAX_RECORD_LINES ) { parsed = start;  break; }
+
+      ++malformed;
+      std::size_t next = pending.find( "\n\"", start );
+      if( next == std::string::npos ) { parsed = pending.size();  break; }
+      parsed = next + 1;
+    }
+    pending.erase( 0, parsed );
+  };
+
+  while( std::getline( input, line ) )
   {
-    _data.push_back( std::move(item) );
+    if( pending.empty() ) pending.swap( line );
+    else                  pending += line;
+    pending += '\n';
+    parsePending( false );
   }
-  /////////////////////// END-TO-DO (2) ////////////////////////////
+  parsePending( true );
+  return malformed;
+}
+
+
+
+
+// resolveDuplicates(...)
+GroceryItemDatabase::Duplicates GroceryItemDatabase::resolveDuplicates( std::vector<GroceryItem> & items, const std::string & source, std::vector<UpcIndex::Key> * keys )
+{
+  const char *    policyName = std::getenv( "GROCERY_DB_DUPLICATE_POLICY" );
+  DuplicatePolicy policy     = DuplicatePolicy::KeepFirst;
+  if     ( policyName == nullptr || *policyName == '\0' || std::string_view( policyName ) == "first" ) /* intentionally empty*/ ;
+  else if( std::string_view( policyName ) == "last"         ) policy = DuplicatePolicy::KeepLast;
+  else if( std::string_view( policyName ) == "lowest-price" ) policy = DuplicatePolicy::KeepLowestPrice;
+  else std::cerr << "Warning:  Unknown GROCERY_DB_DUPLICATE_POLICY \"" << policyName << "\".  Keeping the first of each duplicate UPC read\n\n";
 
-  // Note:  The file is intentionally not explicitly closed.  The file is closed when fin goes out of scope - for whatever
-  //        reason.  More precisely, the object named "fin" is destroyed when it goes out of scope and the file is closed in the
-  //        destructor. See RAII
+  std::ofstream report;
+  if( const char * reportName = std::getenv( "GROCERY_DB_DUPLICATE_REPORT" );  reportName != nullptr && *reportName != '\0' )
+  {
+    report.open( reportName, std::ios::trunc );
+    if( !report.is_open() ) std::cerr << "Warning:  Could not create duplicate UPC report \"" << reportName << "\"\n\n";
+  }
+
+  std::vector<UpcIndex::Key> packedKeys;
+  Duplicates duplicates = sortByUpc( items, policy, report.is_open() ? &report : nullptr, keys != nullptr ? *keys : packedKeys );
+  if( duplicates.upcs > 0 )
+  {
+    static constexpr const char * KEPT[] = { "the first read", "the last read", "the lowest priced" };
+    std::cerr << "Warning:  Found " << duplicates.upcs << " UPCs with more than one record in " << source
+              << ".  Kept " << KEPT[ static_cast<int>( policy ) ] << " of each, dropping " << duplicates.dropped << " records.  Ex:";
+    for( auto && upc : duplicates.examples ) std::cerr << "  " << upc;
+    std::cerr << "\n\n";
+  }
+  return duplicates;
 }
 
 
 
 
+// Keep the records in UPC order so lookups can binary search and range queries can return a contiguous slice.  When every UPC packs
+// into an integer key (they're all decimal digits in practice) the (key, file position) pairs are sorted instead of the records
+// themselves - swapping 16-byte pairs is much cheaper than swapping three strings and a double.  Sorting on file position as the tie
+// breaker puts records sharing a UPC next to each other, in file order, so the duplicates fall out of a single pass over the pairs.
+// The records are then moved into place in place, a cycle of the permutation at a time, so sorting never holds two copies of them.
+GroceryItemDatabase::Duplicates GroceryItemDatabase::sortByUpc( std::vector<GroceryItem> & items, DuplicatePolicy policy, std::ostream * report,
+                                                                std::vector<UpcIndex::Key> & keys )
+{
+  std::vector<std::pair<UpcIndex::Key, std::size_t>> order;
+  order.reserve( items.size() );
+
+  bool packed = true;
+  for( std::size_t position = 0; position < items.size() && packed; ++position )
+  {
+    auto key = UpcIndex::pack( items[position].upcCode() );
+    if( key ) order.emplace_back( *key, position );
+    else      packed = false;
+  }
+
+  if( packed ) parallelSort( order, std::less<>{} );
+  else
+  {
+    // Some UPC isn't packable, so compare the strings themselves
+    order.clear();
+    for( std::size_t position = 0; position < items.size(); ++position ) order.emplace_back( 0, position );
+    parallelSort( order, [&items]( auto const & lhs, auto const & rhs )
+    {
+      int comparison = items[lhs.second].upcCode().compare( items[rhs.second].upcCode() );
+      return comparison < 0 || ( comparison == 0 && lhs.second < rhs.second );
+    } );
+  }
+
+  auto sameUpc = [&]( std::size_t lhs, std::size_t rhs )
+  {
+    return packed ? order[lhs].first == order[rhs].first : items[ order[lhs].second ].upcCode() == items[ order[rhs].second ].upcCode();
+  };
+
+
+  // Keep one record from each run of records sharing a UPC.  The kept records' pairs are compacted to the front of order, and the
+  // dropped records' positions follow them, so order becomes a permutation of every record:  order[i].second is where the record
+  // that belongs at i is now
+  constexpr std::size_t EXAMPLES = 3;
+
+  Duplicates               duplicates;
+  std::vector<std::size_t> dropped;
+  std::size_t              kept = 0;                                            // records kept so far
+  for( std::size_t first = 0, last = 0; first < order.size(); first = last )
+  {
+    for( last = first + 1; last < order.size() && sameUpc( first, last ); ++last ) /* intentionally empty*/ ;
+
+    std::size_t keep = order[first].second;                                     // the first read
+    if( last - first > 1 )
+    {
+      if( policy == DuplicatePolicy::KeepLast ) keep = order[last - 1].second;
+      if( policy == DuplicatePolicy::KeepLowestPrice )
+      {
+        for( std::size_t i = first + 1; i < last; ++i ) if( items[ order[i].second ].price() < items[keep].price() ) keep = order[i].second;
+      }
+
+      ++duplicates.upcs;
+      duplicates.dropped += last - first - 1;
+      if( duplicates.examples.size() < EXAMPLES ) duplicates.examples.push_back( items[keep].upcCode() );
+      for( std::size_t i = first; i < last; ++i )
+      {
+        if( report != nullptr ) *report << ( order[i].second == keep ? "kept     " : "dropped  " ) << items[ order[i].second ] << '\n';
+        if( order[i].second != keep ) dropped.push_back( order[i].second );
+      }
+    }
+
+    order[kept++] = { order[first].first, keep };                               // kept <= first, so the run is already read
+  }
+  for( std::size_t i = 0; i < dropped.size(); ++i ) order[kept + i].second = dropped[i];
+
+
+  // Follow each cycle of the permutation, moving every record in it one step, and mark each place filled as its own source
+  for( std::size_t start = 0; start < order.size(); ++start )
+  {
+    if( order[start].second == start ) continue;
+
+    GroceryItem moving = std::move( items[start] );
+    std::size_t to     = start;
+    for( std::size_t from = order[to].second;  from != start;  from = order[to].second )
+    {
+      items[to]        = std::move( items[from] );
+      order[to].second = to;
+      to               = from;
+    }
+    items[to]        = std::move( moving );
+    order[to].second = to;
+  }
+  items.erase( items.begin() + static_cast<std::ptrdiff_t>( kept ), items.end() );
+
+  keys.clear();
+  if( packed )
+  {
+    keys.reserve( kept );
+    for( std::size_t i = 0; i < kept; ++i ) keys.push_back( order[i].first );
+  }
+  return duplicates;
+}
+
+
+
+
+std::size_t GroceryItemDatabase::lowerBound( std::string_view upc ) const
+{
+  if( !_index.empty() )
+  {
+    if( auto key = UpcIndex::pack( upc ) ) return _index.lowerBound( *key );
+  }
+
+  // Either the UPCs aren't all packable, or the one sought isn't.  Fall back to comparing strings.
+  auto first = std::lower_bound( _data.begin(), _data.end(), upc, []( const GroceryItem & item, std::string_view value ) { return item.upcCode() < value; } );
+  return static_cast<std::size_t>( first - _data.begin() );
+}
+
+
+
 
 
 
@@ -86,13 +424,80 @@ GroceryItemDatabase::GroceryItemDatabase( const std::string & filename )
 ///////////////////////// TO-DO (3) //////////////////////////////
 GroceryItem * GroceryItemDatabase::find( const std::string & upc )
 {
-  return find( upc, 0 );
+  auto timer    = _counters.startFind();
+  auto position = lowerBound( upc );
+
+  GroceryItem * found = position < _data.size() && _data[position].upcCode() == upc ? &_data[position] : nullptr;
+  _counters.recordFind( timer, found != nullptr );
+  return found;
+}
+
+std::span<GroceryItem const> GroceryItemDatabase::findRange( const std::string & fromUpc, const std::string & toUpc ) const
+{
+  if( !( fromUpc < toUpc ) ) return {};
+
+  auto first = lowerBound( fromUpc );
+  auto last  = lowerBound( toUpc   );
+  return std::span<GroceryItem const>( _data ).subspan( first, last - first );
+}
+
+std::span<GroceryItem const> GroceryItemDatabase::findByPrefix( const std::string & upcPrefix ) const
+{
+  // The items sharing a prefix are adjacent in UPC order, so the answer is the slice between two searches - proportional to the
+  // number of items found, not the size of the database
+  if( upcPrefix.empty() ) return _data;
+
+  if( !_index.empty() )
+  {
+    if( auto range = UpcIndex::prefixRange( upcPrefix ) )
+    {
+      auto first = _index.lowerBound( range->first );
+      auto last  = _index.lowerBound( range->last  );
+      return std::span<GroceryItem const>( _data ).subspan( first, last - first );
+    }
+  }
+
+  // Either the UPCs aren't all packable, or the prefix isn't.  Fall back to comparing strings.
+  auto first = _data.begin() + static_cast<std::ptrdiff_t>( lowerBound( upcPrefix ) );
+  auto last  = std::partition_point( first, _data.end(), [&]( const GroceryItem & item ) { return item.upcCode().starts_with( upcPrefix ); } );
+  return std::span<GroceryItem const>( first, last );
+}
+
+std::size_t GroceryItemDatabase::size() const
+{
+  return _data.size();
+}
+
+std::span<GroceryItem const> GroceryItemDatabase::items() const
+{
+  return _data;
+}
+
+GroceryItemDatabaseMetrics GroceryItemDatabase::metrics() const
+{
+  return _counters.snapshot();
+}
+
+void GroceryItemDatabase::startMetricsDump( std::ostream & stream, std::chrono::milliseconds interval )
+{
+  if constexpr( !GroceryItemDatabaseCounters::ENABLED ) return;
+
+  stopMetricsDump();
+  _metricsDump = std::jthread( [this, &stream, interval]( std::stop_token stopToken )
+  {
+    std::mutex                  mutex;
+    std::condition_variable_any sleeper;
+    std::unique_lock            lock( mutex );
+    while( !sleeper.wait_for( lock, stopToken, interval, [&] { return stopToken.stop_requested(); } ) ) stream << metrics() << std::endl;
+  } );
 }
 
-GroceryItem * GroceryItemDatabase::find( const std::string & upc, std::size_t index )
+void GroceryItemDatabase::stopMetricsDump()
 {
-  if( index >= _data.size() ) return nullptr;
-  if( _data[index].upcCode() == upc ) return &_data[index];
-  return find( upc, index + 1 );
+  if( _metricsDump.joinable() )
+  {
+    _metricsDump.request_stop();
+    _metricsDump.join();
+  }
 }
 /////////////////////// END-TO-DO (3) ////////////////////////////
@@ -2,9 +2,16 @@
 
 ///////////////////////// TO-DO (1) //////////////////////////////
 #include <vector>
+#include <chrono>
+#include <iosfwd>
+#include <span>
 #include <string>
-#include <cstddef>  
+#include <string_view>
+#include <thread>
+#include <cstddef>
 #include "GroceryItem.hpp"
+#include "GroceryItemDatabaseMetrics.hpp"
+#include "UpcIndex.hpp"
 /////////////////////// END-TO-DO (1) ////////////////////////////
 
 
@@ -15,11 +22,49 @@ class GroceryItemDatabase
     // Get a reference to the one and only instance of the database
     static GroceryItemDatabase & instance();
 
+    // The UPC is the primary key.  When the database file has several records with the same UPC (merged vendor feeds do), loading
+    // keeps one of them, chosen by the GROCERY_DB_DUPLICATE_POLICY environment variable:  "first" (the default), "last", or
+    // "lowest-price" (the first of those sharing the lowest price).  The conflicts are reported as a warning and in the metrics, and
+    // GROCERY_DB_DUPLICATE_REPORT names a file to list every record involved, kept or dropped
+    enum class DuplicatePolicy { KeepFirst, KeepLast, KeepLowestPrice };
+
+    struct Duplicates
+    {
+      std::size_t              upcs    = 0;                                     // UPCs with more than one record
+      std::size_t              dropped = 0;                                     // records not kept
+      std::vector<std::string> examples;                                        // the first few such UPCs, in UPC order
+    };
+
+    // Reads every GroceryItem in input, appending them to items, and returns the number of malformed records skipped.  Records are
+    // separated by whitespace and may wrap onto following lines; a malformed record is skipped to the next line that starts with a
+    // double quote.  Tools that read database files themselves (see GroceryCatalogEmbedder.cpp) use it to accept the same files
+    static std::size_t readItems( std::istream & input, std::vector<GroceryItem> & items );
+
+    // Sorts items, read from source, by UPC and keeps one item per UPC exactly as loading the database does - by the environment's
+    // policy, with the same warning and report - so tools that build other stores of the records (see GroceryCatalogEmbedder.cpp)
+    // keep the same item find() would return.  If every UPC packs into a UpcIndex::Key, the kept items' keys are written to keys
+    static Duplicates resolveDuplicates( std::vector<GroceryItem> & items, const std::string & source, std::vector<UpcIndex::Key> * keys = nullptr );
+
     // Locate and return a reference to a particular record
     GroceryItem * find( const std::string & upc );                              // Returns a pointer to the item in the database if
                                                                                 // found, nullptr otherwise
+
+    // Locate the records in a range of UPCs.  The spans are read only:  the items are kept in UPC order, so changing a UPC through
+    // one would hide the item from find() and the range queries
+    std::span<GroceryItem const> findRange   ( const std::string & fromUpc,    // Returns, in UPC order, the items whose UPC is at least fromUpc
+                                               const std::string & toUpc ) const;   // but less than toUpc.  Ex: findRange( "00038000", "00038001" )
+    std::span<GroceryItem const> findByPrefix( const std::string & upcPrefix ) const;   // Returns, in UPC order, the items whose UPC starts with
+                                                                                // upcPrefix.  Ex: findByPrefix( "00038000" ) returns all of Kellogg's products
+
     // Queries
-    std::size_t size() const;                                                   // Returns the number of items in the database
+    std::size_t                  size () const;                                 // Returns the number of items in the database
+    std::span<GroceryItem const> items() const;                                 // Returns every item in the database, in UPC order
+
+    // Metrics (see GroceryItemDatabaseMetrics.hpp)
+    GroceryItemDatabaseMetrics metrics() const;                                 // Returns a snapshot of the load and lookup metrics
+    void startMetricsDump( std::ostream & stream,                               // Writes a snapshot to stream, as a line of JSON, every interval
+                           std::chrono::milliseconds interval );                // until stopped.  Replaces any dump already running
+    void stopMetricsDump ();
 
   private:
     GroceryItemDatabase            ( const std::string & filename );
@@ -28,8 +73,17 @@ class GroceryItemDatabase
     GroceryItemDatabase & operator=( const GroceryItemDatabase & ) = delete;    // intentionally prohibit copy assignments
 
     ///////////////////////// TO-DO (2) //////////////////////////////
-    std::vector<GroceryItem> _data;
+    std::vector<GroceryItem> _data;                                             // Kept sorted by UPC, one item per UPC
+    UpcIndex                 _index;                                            // Packed UPC keys of _data, empty if any UPC is not packable
+
+    GroceryItemDatabaseCounters _counters;
+    std::jthread                _metricsDump;                                   // declared last so it's stopped before the counters go away
+
+    static Duplicates sortByUpc( std::vector<GroceryItem> & items,              // Sorts items by UPC, keeping one item per UPC, lists the
+                                 DuplicatePolicy policy, std::ostream * report, // items sharing a UPC to report, if given, and returns
+                                 std::vector<UpcIndex::Key> & keys );           // the kept items' keys in keys, or none if any UPC won't pack
 
-    GroceryItem * find(const std::string & upc, std::size_t index);
+    std::size_t lowerBound( std::string_view upc ) const;                       // Returns the position in _data of the first item whose
+                                                                                // UPC is not less than upc
     /////////////////////// END-TO-DO (2) ////////////////////////////
 };
@@ -0,0 +1,144 @@
+#include <algorithm>                                                                      // max()
+#include <chrono>                                                                         // steady_clock
+#include <cstddef>                                                                        // size_t
+#include <cstdlib>                                                                        // strtoull()
+#include <exception>                                                                      // exception
+#include <iostream>                                                                       // cerr
+#include <queue>                                                                          // queue
+#include <random>                                                                         // mt19937_64
+#include <span>                                                                           // span
+#include <sstream>                                                                        // ostringstream, istringstream
+#include <stack>                                                                          // stack
+#include <string>
+#include <string_view>
+#include <utility>                                                                        // move()
+#include <vector>
+
+#include "BenchmarkReport.hpp"
+#include "GroceryItem.hpp"
+#include "GroceryItemDatabase.hpp"
+
+
+
+namespace
+{
+  template<typename Body>
+  std::chrono::steady_clock::duration time( Body body )
+  {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::steady_clock::now() - start;
+  }
+
+
+
+  // The same recursive algorithm main() uses to move grocery items from a broken cart to a working cart, without the tracing
+  std::size_t moveGroceryItems( std::size_t quantity, std::stack<GroceryItem> & broken_cart, std::stack<GroceryItem> & working_cart, std::stack<GroceryItem> & spare_cart )
+  {
+    if( quantity == 0 ) return 0;
+
+    std::size_t moves = moveGroceryItems( quantity - 1, broken_cart, spare_cart, working_cart );
+    working_cart.push( std::move( broken_cart.top() ) );
+    broken_cart.pop();
+    return moves + 1 + moveGroceryItems( quantity - 1, spare_cart, working_cart, broken_cart );
+  }
+}    // namespace
+
+
+
+
+// main()
+//    GroceryItemDatabaseBenchmark [queries [cartSize]]
+//
+// Benchmarks GroceryItemDatabase against whichever database instance() finds - set GROCERY_UPC_DATABASE to choose one, for example
+// a synthetic database written by GroceryDatabaseGenerator.  Each measurement is written to standard output as a line of JSON.
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    std::size_t queries  = argc >= 2 ? std::strtoull( argv[1], nullptr, 10 ) : 200'000;
+    std::size_t cartSize = argc >= 3 ? std::strtoull( argv[2], nullptr, 10 ) :      16;
+
+    // Load
+    GroceryItemDatabase * database = nullptr;
+    auto elapsed = time( [&] { database = &GroceryItemDatabase::instance(); } );
+    std::size_t records = database->size();
+    report( "load", records, records, elapsed );
+
+    std::span<GroceryItem const> everything = database->items();
+    if( everything.empty() )
+    {
+      std::cerr << "Error:  The database is empty.  Set GROCERY_UPC_DATABASE to the database to benchmark\n";
+      return 1;
+    }
+
+
+    // Lookups.  Hits are drawn from the database itself; misses are 13-digit codes, which are neither UPC-A nor GTIN-14 codes
+    std::mt19937_64 random( 20240229 );
+    std::vector<std::string> hits, misses;
+    hits  .reserve( queries );
+    misses.reserve( queries );
+    for( std::size_t i = 0; i < queries; ++i ) hits.push_back( everything[ random() % everything.size() ].upcCode() );
+    for( std::size_t i = 0; i < queries; ++i ) misses.push_back( std::to_string( 1'000'000'000'000ULL + random() % 9'000'000'000'000ULL ) );
+
+    double found = 0.0;
+    elapsed = time( [&] { for( auto && upc : hits   ) found += database->find( upc ) != nullptr; } );
+    report( "find_hit", records, hits.size(), elapsed, found );
+
+    found = 0.0;
+    elapsed = time( [&] { for( auto && upc : misses ) found += database->find( upc ) != nullptr; } );
+    report( "find_miss", records, misses.size(), elapsed, found );
+
+    found = 0.0;
+    elapsed = time( [&] { for( auto && upc : hits   ) found += static_cast<double>( database->findByPrefix( upc.substr( 0, upc.size() - 4 ) ).size() ); } );
+    report( "find_by_prefix", records, hits.size(), elapsed, found );
+
+
+    // Serialization, both directions, through GroceryItem's insertion and extraction operators
+    std::ostringstream serialized;
+    elapsed = time( [&] { for( auto && item : everything ) serialized << item << '\n'; } );
+    report( "serialize", records, everything.size(), elapsed, static_cast<double>( serialized.view().size() ) );
+
+    std::istringstream source( serialized.str() );
+    std::size_t parsed = 0;
+    elapsed = time( [&] { for( GroceryItem item; source >> item; ) ++parsed; } );
+    report( "deserialize", records, parsed, elapsed, static_cast<double>( parsed ) );
+
+
+    // Moving a cart's worth of grocery items to another cart takes 2^n - 1 moves
+    std::stack<GroceryItem> brokenCart, workingCart, spareCart;
+    for( std::size_t i = 0; i < cartSize; ++i ) brokenCart.push( everything[ random() % everything.size() ] );
+    std::size_t moves = 0;
+    elapsed = time( [&] { moves = moveGroceryItems( brokenCart.size(), brokenCart, workingCart, spareCart ); } );
+    report( "cart_move", records, moves, elapsed, static_cast<double>( workingCart.size() ) );
+
+
+    // Checkout:  items go from the cart onto the conveyor belt, then each is looked up and rung up, as main() does
+    std::size_t checkoutItems = 0;
+    double      amountDue     = 0.0;
+    elapsed = time( [&]
+    {
+      for( std::size_t customer = 0; customer < queries / std::max<std::size_t>( cartSize, 1 ); ++customer )
+      {
+        std::stack<GroceryItem> cart;
+        for( std::size_t i = 0; i < cartSize; ++i ) cart.push( GroceryItem( {}, {}, hits[ ( customer * cartSize + i ) % hits.size() ] ) );
+
+        std::queue<GroceryItem> checkoutCounter;
+        for( ; !cart.empty(); cart.pop() ) checkoutCounter.push( std::move( cart.top() ) );
+
+        for( ; !checkoutCounter.empty(); checkoutCounter.pop(), ++checkoutItems )
+        {
+          if( GroceryItem * item = database->find( checkoutCounter.front().upcCode() ); item != nullptr ) amountDue += item->price();
+        }
+      }
+    } );
+    report( "checkout", records, checkoutItems, elapsed, amountDue );
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,209 @@
+#include <algorithm>                                                          // min()
+#include <bit>                                                                // bit_width()
+#include <chrono>
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint64_t
+#include <iostream>                                                           // ostream
+
+#include "GroceryItemDatabaseMetrics.hpp"
+
+
+
+/*******************************************************************************
+**  Log2Histogram
+*******************************************************************************/
+
+// bucket(...)
+std::size_t Log2Histogram::bucket( std::uint64_t value ) noexcept
+{
+  return std::min<std::size_t>( static_cast<std::size_t>( std::bit_width( value ) ), BUCKETS - 1 );
+}
+
+
+
+
+// samples()
+std::uint64_t Log2Histogram::samples() const noexcept
+{
+  std::uint64_t total = 0;
+  for( auto count : counts ) total += count;
+  return total;
+}
+
+
+
+
+// percentile(...)
+std::uint64_t Log2Histogram::percentile( double fraction ) const noexcept
+{
+  auto total = samples();
+  if( total == 0 ) return 0;
+
+  std::uint64_t wanted = static_cast<std::uint64_t>( fraction * static_cast<double>( total ) + 0.5 );
+  std::uint64_t seen   = 0;
+  for( std::size_t i = 0; i < BUCKETS; ++i )
+  {
+    seen += counts[i];
+    if( seen >= wanted && seen > 0 ) return i == 0 ? 0 : std::uint64_t{ 1 } << i;
+  }
+  return std::uint64_t{ 1 } << ( BUCKETS - 1 );
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  GroceryItemDatabaseMetrics
+*******************************************************************************/
+
+// recordsPerSecond()
+double GroceryItemDatabaseMetrics::recordsPerSecond() const noexcept
+{
+  double seconds = std::chrono::duration<double>( loadDuration ).count();
+  return seconds > 0.0 ? static_cast<double>( recordsLoaded ) / seconds : 0.0;
+}
+
+
+
+
+// operator<<(...)
+std::ostream & operator<<( std::ostream & stream, GroceryItemDatabaseMetrics const & metrics )
+{
+  auto histogram = [&]( const char * name, Log2Histogram const & values )
+  {
+    stream << ",\"" << name << "\":{\"samples\":" << values.samples()
+           << ",\"p50\":"  << values.percentile( 0.50  )
+           << ",\"p90\":"  << values.percentile( 0.90  )
+           << ",\"p99\":"  << values.percentile( 0.99  )
+           << ",\"p999\":" << values.percentile( 0.999 )
+           << ",\"log2_buckets\":[";
+    for( std::size_t i = 0; i < Log2Histogram::BUCKETS; ++i ) stream << ( i == 0 ? "" : "," ) << values.counts[i];
+    stream << "]}";
+  };
+
+  stream << "{\"load_ns\":"            << metrics.loadDuration.count()
+         << ",\"records_loaded\":"     << metrics.recordsLoaded
+         << ",\"records_per_second\":" << metrics.recordsPerSecond()
+         << ",\"parse_failures\":"     << metrics.parseFailures
+         << ",\"open_failures\":"      << metrics.openFailures
+         << ",\"duplicate_upcs\":"     << metrics.duplicateUpcs
+         << ",\"duplicates_dropped\":" << metrics.duplicatesDropped
+         << ",\"index_depth\":"        << metrics.indexDepth
+         << ",\"find_calls\":"         << metrics.findCalls
+         << ",\"find_hits\":"          << metrics.findHits
+         << ",\"find_misses\":"        << metrics.findMisses;
+  histogram( "find_latency_ns", metrics.findLatency );
+  return stream << '}';
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  GroceryItemDatabaseCounters
+*******************************************************************************/
+#ifndef GROCERY_DB_NO_METRICS
+
+static_assert( ( GroceryItemDatabaseCounters::LATENCY_SAMPLE_EVERY & ( GroceryItemDatabaseCounters::LATENCY_SAMPLE_EVERY - 1 ) ) == 0 );
+
+
+// startFind()
+GroceryItemDatabaseCounters::FindTimer GroceryItemDatabaseCounters::startFind() const noexcept
+{
+  thread_local unsigned calls = 0;
+  if( ( ++calls & ( LATENCY_SAMPLE_EVERY - 1 ) ) != 0 ) return {};            // not sampled, leave the time empty
+  return { std::chrono::steady_clock::now() };
+}
+
+
+
+
+// recordFind(...)
+void GroceryItemDatabaseCounters::recordFind( FindTimer timer, bool hit ) noexcept
+{
+  static std::atomic<std::size_t> nextShard{ 0 };
+  thread_local std::size_t const  myShard = nextShard.fetch_add( 1, std::memory_order_relaxed ) % FIND_SHARDS;
+
+  FindShard & shard = _findShards[myShard];
+  ( hit ? shard.hits : shard.misses ).fetch_add( 1, std::memory_order_relaxed );
+
+  if( timer.start != std::chrono::steady_clock::time_point{} )
+  {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - timer.start ).count();
+    shard.latency[ Log2Histogram::bucket( static_cast<std::uint64_t>( elapsed ) ) ].fetch_add( 1, std::memory_order_relaxed );
+  }
+}
+
+
+
+
+// recordLoad(...)
+void GroceryItemDatabaseCounters::recordLoad( std::chrono::nanoseconds duration, std::uint64_t records, std::uint64_t indexDepth ) noexcept
+{
+  _loadNanoseconds.store( duration.count(), std::memory_order_relaxed );
+  _recordsLoaded  .store( records,          std::memory_order_relaxed );
+  _indexDepth     .store( indexDepth,       std::memory_order_relaxed );
+}
+
+
+
+
+// recordParseFailures(...)
+void GroceryItemDatabaseCounters::recordParseFailures( std::uint64_t count ) noexcept
+{
+  _parseFailures.fetch_add( count, std::memory_order_relaxed );
+}
+
+
+
+
+// recordOpenFailure()
+void GroceryItemDatabaseCounters::recordOpenFailure() noexcept
+{
+  _openFailures.fetch_add( 1, std::memory_order_relaxed );
+}
+
+
+
+
+// recordDuplicates(...)
+void GroceryItemDatabaseCounters::recordDuplicates( std::uint64_t upcs, std::uint64_t dropped ) noexcept
+{
+  _duplicateUpcs    .fetch_add( upcs,    std::memory_order_relaxed );
+  _duplicatesDropped.fetch_add( dropped, std::memory_order_relaxed );
+}
+
+
+
+
+// snapshot()
+GroceryItemDatabaseMetrics GroceryItemDatabaseCounters::snapshot() const noexcept
+{
+  GroceryItemDatabaseMetrics metrics;
+  metrics.loadDuration      = std::chrono::nanoseconds( _loadNanoseconds.load( std::memory_order_relaxed ) );
+  metrics.recordsLoaded     = _recordsLoaded    .load( std::memory_order_relaxed );
+  metrics.parseFailures     = _parseFailures    .load( std::memory_order_relaxed );
+  metrics.openFailures      = _openFailures     .load( std::memory_order_relaxed );
+  metrics.duplicateUpcs     = _duplicateUpcs    .load( std::memory_order_relaxed );
+  metrics.duplicatesDropped = _duplicatesDropped.load( std::memory_order_relaxed );
+  metrics.indexDepth        = _indexDepth       .load( std::memory_order_relaxed );
+
+  for( auto && shard : _findShards )
+  {
+    metrics.findHits   += shard.hits  .load( std::memory_order_relaxed );
+    metrics.findMisses += shard.misses.load( std::memory_order_relaxed );
+    for( std::size_t i = 0; i < Log2Histogram::BUCKETS; ++i ) metrics.findLatency.counts[i] += shard.latency[i].load( std::memory_order_relaxed );
+  }
+  metrics.findCalls = metrics.findHits + metrics.findMisses;
+  return metrics;
+}
+
+#endif    // GROCERY_DB_NO_METRICS
@@ -0,0 +1,123 @@
+#pragma once                                                                  // include guard
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint64_t
+#include <iosfwd>                                                             // ostream
+
+
+
+
+// Hot path instrumentation for GroceryItemDatabase
+//
+// Metrics are compiled in by default.  Define GROCERY_DB_NO_METRICS (Ex: -DGROCERY_DB_NO_METRICS) to compile them out entirely:  the
+// recording functions become empty inline functions and snapshots come back all zeros.
+
+
+
+
+// A histogram with power of two buckets:  bucket i counts the values in [2^(i-1), 2^i), and bucket 0 counts zeros
+struct Log2Histogram
+{
+  static constexpr std::size_t BUCKETS = 48;                                  // 2^47 ns is well over a day
+
+  std::array<std::uint64_t, BUCKETS> counts{};
+
+  static std::size_t  bucket    ( std::uint64_t value ) noexcept;
+  std::uint64_t       samples   (                     ) const noexcept;
+  std::uint64_t       percentile( double fraction     ) const noexcept;       // Returns the upper bound of the bucket holding the given
+};                                                                            // fraction (Ex: 0.99) of the samples
+
+
+
+
+// A point in time snapshot of the database's metrics
+struct GroceryItemDatabaseMetrics
+{
+  std::chrono::nanoseconds loadDuration{ 0 };                                 // time spent reading, parsing, and indexing the database file
+  std::uint64_t            recordsLoaded     = 0;
+  std::uint64_t            parseFailures     = 0;                             // malformed records skipped while loading
+  std::uint64_t            openFailures      = 0;                             // the database file could not be opened
+  std::uint64_t            duplicateUpcs     = 0;                             // UPCs with more than one record in the database file
+  std::uint64_t            duplicatesDropped = 0;                             // records dropped resolving them
+
+  std::uint64_t            indexDepth        = 0;                             // index nodes (cache lines) every find() visits, or 0 if
+                                                                              // finds fall back to a binary search of the UPC strings
+  std::uint64_t            findCalls         = 0;
+  std::uint64_t            findHits          = 0;
+  std::uint64_t            findMisses        = 0;
+  Log2Histogram            findLatency;                                       // nanoseconds, sampled (see GroceryItemDatabaseCounters)
+
+  double recordsPerSecond() const noexcept;
+};
+
+std::ostream & operator<<( std::ostream & stream, GroceryItemDatabaseMetrics const & metrics );   // one line of JSON
+
+
+
+
+// The live counters.  Recording is lock free and wait free:  each counter is a relaxed atomic.  The lookup counters, written on
+// every find(), are split into FIND_SHARDS cache line aligned shards, one per thread (round robin past FIND_SHARDS threads), and
+// summed by snapshot(), so concurrent readers of the database don't contend for the same cache lines.  Reading the clock costs about
+// as much as a lookup, so only one in LATENCY_SAMPLE_EVERY lookups per thread is timed.
+//
+// There's no probe length histogram:  a UpcIndex search visits every level of the tree, so every lookup probes the same number of
+// nodes.  That number is recorded once, as the index depth.
+class GroceryItemDatabaseCounters
+{
+  public:
+    static constexpr unsigned    LATENCY_SAMPLE_EVERY = 16;                   // must be a power of two
+    static constexpr std::size_t FIND_SHARDS          = 32;
+
+    #ifndef GROCERY_DB_NO_METRICS
+      static constexpr bool ENABLED = true;
+
+      // Started at the top of find(), holds the time only for sampled calls
+      struct FindTimer { std::chrono::steady_clock::time_point start{}; };
+
+      FindTimer startFind          () const noexcept;
+      void      recordFind         ( FindTimer timer, bool hit ) noexcept;
+      void      recordLoad         ( std::chrono::nanoseconds duration, std::uint64_t records, std::uint64_t indexDepth ) noexcept;
+      void      recordParseFailures( std::uint64_t count ) noexcept;
+      void      recordOpenFailure  () noexcept;
+      void      recordDuplicates   ( std::uint64_t upcs, std::uint64_t dropped ) noexcept;
+
+      GroceryItemDatabaseMetrics snapshot() const noexcept;
+
+    private:
+      using Buckets = std::array<std::atomic<std::uint64_t>, Log2Histogram::BUCKETS>;
+
+      std::atomic<std::int64_t>  _loadNanoseconds  { 0 };
+      std::atomic<std::uint64_t> _recordsLoaded    { 0 };
+      std::atomic<std::uint64_t> _parseFailures    { 0 };
+      std::atomic<std::uint64_t> _openFailures     { 0 };
+      std::atomic<std::uint64_t> _duplicateUpcs    { 0 };
+      std::atomic<std::uint64_t> _duplicatesDropped{ 0 };
+      std::atomic<std::uint64_t> _indexDepth       { 0 };
+
+      struct alignas( 64 ) FindShard                                          // alignment keeps each shard, and the load counters, on their
+      {                                                                       // own cache lines
+        std::atomic<std::uint64_t> hits   { 0 };
+        std::atomic<std::uint64_t> misses { 0 };
+        Buckets                    latency{};
+      };
+
+      std::array<FindShard, FIND_SHARDS> _findShards{};
+
+    #else
+      static constexpr bool ENABLED = false;
+
+      struct FindTimer {};
+
+      FindTimer startFind          (                                   ) const noexcept { return {}; }
+      void      recordFind         ( FindTimer, bool                   ) noexcept {}
+      void      recordLoad         ( std::chrono::nanoseconds, std::uint64_t, std::uint64_t ) noexcept {}
+      void      recordParseFailures( std::uint64_t                     ) noexcept {}
+      void      recordOpenFailure  (                                   ) noexcept {}
+      void      recordDuplicates   ( std::uint64_t, std::uint64_t      ) noexcept {}
+
+      GroceryItemDatabaseMetrics snapshot() const noexcept { return {}; }
+    #endif
+};
@@ -0,0 +1,67 @@
+#include <exception>                                                                      // exception
+#include <iostream>                                                                       // cout, cerr
+#include <string>
+#include <string_view>
+
+#include "GroceryItemDatabase.hpp"
+#include "SharedGroceryItemDatabase.hpp"
+
+
+
+// main()
+//    GroceryItemDatabasePublisher [--unpublish | --allow-empty] [name]
+//
+// Loads the grocery item database once and publishes it to shared memory, where every SharedGroceryItemDatabase on the host can
+// attach to it.  Run it again after the database file changes; processes already attached keep the image they have until they
+// reattach.  With --unpublish, removes the image instead.  A database file that couldn't be opened, or that holds no items, isn't
+// published - that would replace a good image every lane attaches to with an empty one - unless --allow-empty is given.
+//    Ex:  GroceryItemDatabasePublisher /GroceryItemDatabase
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    bool        unpublish  = false;
+    bool        allowEmpty = false;
+    std::string name( SharedGroceryItemDatabase::DEFAULT_NAME );
+
+    for( int i = 1; i < argc; ++i )
+    {
+      std::string_view argument = argv[i];
+      if     ( argument == "--unpublish"   ) unpublish  = true;
+      else if( argument == "--allow-empty" ) allowEmpty = true;
+      else if( argument.starts_with( '/' ) ) name       = argument;
+      else
+      {
+        std::cerr << "Usage:  " << argv[0] << " [--unpublish | --allow-empty] [name]\n"
+                  << "        name must start with a slash, and defaults to " << SharedGroceryItemDatabase::DEFAULT_NAME << '\n';
+        return 2;
+      }
+    }
+
+    if( unpublish )
+    {
+      SharedGroceryItemDatabase::unpublish( name );
+      std::cout << "Unpublished " << name << '\n';
+      return 0;
+    }
+
+    GroceryItemDatabase & worldWideDatabase = GroceryItemDatabase::instance();
+    if( !allowEmpty && ( worldWideDatabase.metrics().openFailures > 0 || worldWideDatabase.size() == 0 ) )
+    {
+      std::cerr << "Error:  The grocery item database is empty or couldn't be opened, so " << name << " was left as it was.  Check GROCERY_UPC_DATABASE,\n"
+                << "        or pass --allow-empty to publish an empty database\n";
+      return 1;
+    }
+    SharedGroceryItemDatabase::publish( name, worldWideDatabase.items() );
+
+    auto shared = SharedGroceryItemDatabase::attach( name );
+    std::cout << "Published " << shared.size() << " grocery items (" << shared.bytes() << " bytes) as " << name << '\n';
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,305 @@
+#include <algorithm>                                                                      // sort(), min()
+#include <atomic>                                                                         // atomic
+#include <cerrno>                                                                         // errno, EINTR
+#include <chrono>                                                                         // steady_clock
+#include <cstddef>                                                                        // size_t
+#include <cstdint>                                                                        // uint32_t
+#include <cstdlib>                                                                        // strtoull()
+#include <deque>
+#include <exception>                                                                      // exception
+#include <iostream>                                                                       // cout, cerr
+#include <random>                                                                         // mt19937_64
+#include <span>
+#include <stdexcept>                                                                      // runtime_error
+#include <string>
+#include <string_view>
+#include <system_error>                                                                   // system_error, generic_category()
+#include <thread>                                                                         // jthread
+#include <utility>                                                                        // pair
+#include <vector>
+
+#include <fcntl.h>                                                                        // fcntl(), O_NONBLOCK
+#include <poll.h>                                                                         // poll()
+#include <sys/socket.h>                                                                   // socket(), connect(), send(), recv()
+#include <sys/un.h>                                                                       // sockaddr_un
+#include <unistd.h>                                                                       // close()
+
+#include "GroceryItem.hpp"
+#include "GroceryItemDatabase.hpp"
+#include "GroceryItemLookupProtocol.hpp"
+
+
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  constexpr std::size_t REQUESTS_PER_CONNECTION = 1024;                                   // distinct request frames each connection cycles through
+  constexpr double      MISS_FRACTION           = 0.10;
+
+
+
+  [[noreturn]] void systemError( std::string const & what )
+  {
+    throw std::system_error( errno, std::generic_category(), what );
+  }
+
+
+
+  struct ConnectionResults
+  {
+    std::size_t                  requests = 0;
+    std::size_t                  lookups  = 0;
+    std::size_t                  found    = 0;
+    std::size_t                  errors   = 0;                                            // responses that didn't match their request
+    std::vector<Clock::duration> latencies;                                               // one per request, send to response
+  };
+
+
+
+  // Runs one client connection until deadline, keeping pipelineDepth requests in flight, then waits for the last responses.  The
+  // socket is non-blocking and poll()ed for both directions, so responses are read while requests are still being sent:  a client
+  // that finished sending before reading would deadlock with a server that stops reading it until its responses are read.  Requests
+  // are held back, too, once the responses owed would pass LOOKUP_SERVER_OUTPUT_LIMIT, so the server never has to throttle us
+  void drive( std::string const & socketPath, std::span<std::string const> requests, std::span<std::size_t const> batchSizes,
+              std::span<std::size_t const> responseBytes, std::size_t pipelineDepth, Clock::time_point deadline, ConnectionResults & results )
+  {
+    int client = ::socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if( client < 0 ) systemError( "Error - Could not create a socket" );
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    socketPath.copy( address.sun_path, sizeof( address.sun_path ) - 1 );
+    if( ::connect( client, reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) != 0 )
+    {
+      ::close( client );
+      systemError( "Error - Could not connect to \"" + socketPath + "\".  Is GroceryItemLookupServer running?" );
+    }
+    if( ::fcntl( client, F_SETFL, ::fcntl( client, F_GETFL ) | O_NONBLOCK ) != 0 )
+    {
+      ::close( client );
+      systemError( "Error - Could not make the connection non-blocking" );
+    }
+
+    std::deque<std::pair<std::size_t, Clock::time_point>> inFlight;                      // request number and when it was sent, oldest first
+    std::size_t    next     = 0;
+    std::size_t    owed     = 0;                                                          // response bytes of the requests in flight
+    std::string    outgoing;                                                              // requests not yet taken by the socket ...
+    std::size_t    sent     = 0;                                                          // ... starting here
+    std::string    received;
+    LookupResponse response;
+    char           chunk[64 * 1024];
+
+    auto sendRequests = [&]
+    {
+      while( inFlight.size() < pipelineDepth && Clock::now() < deadline )
+      {
+        std::size_t slot = next % requests.size();
+        if( !inFlight.empty() && owed + responseBytes[slot] > LOOKUP_SERVER_OUTPUT_LIMIT ) break;
+
+        inFlight.emplace_back( next++, Clock::now() );
+        owed     += responseBytes[slot];
+        outgoing += requests[slot];
+      }
+    };
+
+    sendRequests();
+    while( !inFlight.empty() )
+    {
+      pollfd ready{ client, static_cast<short>( POLLIN | ( sent < outgoing.size() ? POLLOUT : 0 ) ), 0 };
+      if( ::poll( &ready, 1, -1 ) < 0 )
+      {
+        if( errno == EINTR ) continue;
+        systemError( "Error - Waiting for the connection failed" );
+      }
+
+      if( ready.revents & POLLOUT )
+      {
+        while( sent < outgoing.size() )
+        {
+          auto count = ::send( client, outgoing.data() + sent, outgoing.size() - sent, MSG_NOSIGNAL );
+          if( count < 0 && errno == EINTR ) continue;
+          if( count < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) break;
+          if( count < 0 ) systemError( "Error - Could not send a request" );
+          sent += static_cast<std::size_t>( count );
+        }
+        if( sent == outgoing.size() ) { outgoing.clear();  sent = 0; }
+      }
+
+      if( ready.revents & ( POLLIN | POLLHUP | POLLERR ) )
+      {
+        auto count = ::recv( client, chunk, sizeof( chunk ), 0 );
+        if( count < 0 && ( errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK ) ) continue;
+        if( count < 0 )  systemError( "Error - Could not receive a response" );
+        if( count == 0 ) throw std::runtime_error( "Error - The server closed the connection" );
+        received.append( chunk, static_cast<std::size_t>( count ) );
+
+        std::string_view unread = received;
+        auto             now    = Clock::now();
+        while( std::size_t frameSize = lookupFrameSize( unread, 0xFFFF'FFFF ) )
+        {
+          auto [request, sentAt] = inFlight.front();
+          inFlight.pop_front();
+
+          std::size_t slot = request % requests.size();
+          if( !parseLookupResponse( unread.substr( 0, frameSize ), response )
+           || response.id != static_cast<std::uint32_t>( slot ) || response.items.size() != batchSizes[slot] ) ++results.errors;
+
+          ++results.requests;
+          results.lookups += response.items.size();
+          for( auto && item : response.items ) results.found += item.has_value();
+          results.latencies.push_back( now - sentAt );
+          owed -= responseBytes[slot];
+
+          unread.remove_prefix( frameSize );
+        }
+        received.erase( 0, received.size() - unread.size() );
+        sendRequests();
+      }
+    }
+
+    ::close( client );
+  }
+
+
+
+  double percentileMicroseconds( std::vector<Clock::duration> const & sorted, double percentile )
+  {
+    if( sorted.empty() ) return 0.0;
+    std::size_t rank = std::min( sorted.size() - 1, static_cast<std::size_t>( percentile / 100.0 * static_cast<double>( sorted.size() ) ) );
+    return std::chrono::duration<double, std::micro>( sorted[rank] ).count();
+  }
+}    // namespace
+
+
+
+
+// main()
+//    GroceryItemLookupLoadGenerator [connections [seconds [batchSize [pipelineDepth [socketPath]]]]]
+//
+// Drives GroceryItemLookupServer from connections client threads for the given number of seconds, each keeping pipelineDepth
+// requests of batchSize UPCs in flight (fewer if their responses would pass the server's output limit, LOOKUP_SERVER_OUTPUT_LIMIT),
+// then reports the throughput and latency percentiles as a line of JSON.  About 10% of the UPCs asked for aren't in the database.
+// The UPCs asked for are drawn from the same database the server loads, so run both with the same GROCERY_UPC_DATABASE.
+//    Ex:  GroceryItemLookupLoadGenerator 4 10 32 8
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    std::size_t connections   = argc >= 2 ? std::strtoull( argv[1], nullptr, 10 ) :  4;
+    std::size_t seconds       = argc >= 3 ? std::strtoull( argv[2], nullptr, 10 ) :  5;
+    std::size_t batchSize     = argc >= 4 ? std::strtoull( argv[3], nullptr, 10 ) : 16;
+    std::size_t pipelineDepth = argc >= 5 ? std::strtoull( argv[4], nullptr, 10 ) :  8;
+    std::string socketPath    = argc >= 6 ? argv[5] : std::string( LOOKUP_DEFAULT_SOCKET_PATH );
+
+    if( connections == 0 || seconds == 0 || batchSize == 0 || batchSize > LOOKUP_MAX_BATCH || pipelineDepth == 0 || socketPath.size() >= sizeof( sockaddr_un::sun_path ) )
+    {
+      std::cerr << "Usage:  " << argv[0] << " [connections [seconds [batchSize [pipelineDepth [socketPath]]]]]\n"
+                << "        all positive, batchSize at most " << LOOKUP_MAX_BATCH << ", socketPath defaults to " << LOOKUP_DEFAULT_SOCKET_PATH << '\n';
+      return 2;
+    }
+
+    std::span<GroceryItem const> everything = GroceryItemDatabase::instance().items();
+    if( everything.empty() )
+    {
+      std::cerr << "Error:  The database is empty.  Set GROCERY_UPC_DATABASE to the database the server is serving\n";
+      return 1;
+    }
+
+
+    // Build each connection's requests up front so the clients measure the server, not themselves
+    std::mt19937_64                       random( 20240229 );
+    std::bernoulli_distribution           miss  ( MISS_FRACTION );
+    std::vector<std::vector<std::string>> requests     ( connections );                  // request frames, ids are their positions
+    std::vector<std::vector<std::size_t>> batchSizes   ( connections );
+    std::vector<std::vector<std::size_t>> responseBytes( connections );                  // the size of each request's response frame
+    std::vector<std::string>              batch;
+    for( std::size_t connection = 0; connection < connections; ++connection )
+    {
+      for( std::size_t request = 0; request < REQUESTS_PER_CONNECTION; ++request )
+      {
+        batch.clear();
+        std::size_t bytes = LOOKUP_HEADER_BYTES;
+        for( std::size_t i = 0; i < batchSize; ++i )
+        {
+          if( miss( random ) )
+          {
+            batch.push_back( std::to_string( 1'000'000'000'000ULL + random() % 9'000'000'000'000ULL ) );   // 13 digits, never a UPC
+            bytes += 1;                                                                    // status
+          }
+          else
+          {
+            GroceryItem const & item = everything[ random() % everything.size() ];
+            batch.push_back( item.upcCode() );
+            bytes += 1 + 2 + item.brandName().size() + 2 + item.productName().size() + sizeof( double );
+          }
+        }
+        appendLookupRequest( requests[connection].emplace_back(), static_cast<std::uint32_t>( request ), batch );
+        batchSizes   [connection].push_back( batch.size() );
+        responseBytes[connection].push_back( bytes );
+      }
+    }
+
+
+    // Run the clients
+    std::vector<ConnectionResults> results( connections );
+    std::atomic<bool>              failed   = false;
+    auto                           start    = Clock::now();
+    auto                           deadline = start + std::chrono::seconds( seconds );
+    {
+      std::vector<std::jthread> clients;
+      for( std::size_t connection = 0; connection < connections; ++connection )
+      {
+        clients.emplace_back( [&, connection]
+        {
+          try
+          {
+            drive( socketPath, requests[connection], batchSizes[connection], responseBytes[connection], pipelineDepth, deadline, results[connection] );
+          }
+          catch( std::exception & ex )
+          {
+            std::cerr << "Error:  Connection " << connection << ":  " << ex.what() << '\n';
+            failed = true;
+          }
+        } );
+      }
+    }
+    double elapsed = std::chrono::duration<double>( Clock::now() - start ).count();
+    if( failed ) return 1;
+
+
+    ConnectionResults total;
+    for( auto && result : results )
+    {
+      total.requests += result.requests;
+      total.lookups  += result.lookups;
+      total.found    += result.found;
+      total.errors   += result.errors;
+      total.latencies.insert( total.latencies.end(), result.latencies.begin(), result.latencies.end() );
+    }
+    std::sort( total.latencies.begin(), total.latencies.end() );
+
+    std::cout << "{\"benchmark\":\"lookup_server\","
+              <<  "\"connections\":"         << connections                                            << ','
+              <<  "\"batch_size\":"          << batchSize                                              << ','
+              <<  "\"pipeline_depth\":"      << pipelineDepth                                          << ','
+              <<  "\"requests\":"            << total.requests                                         << ','
+              <<  "\"lookups\":"             << total.lookups                                          << ','
+              <<  "\"found\":"               << total.found                                            << ','
+              <<  "\"errors\":"              << total.errors                                           << ','
+              <<  "\"seconds\":"             << elapsed                                                << ','
+              <<  "\"requests_per_second\":" << static_cast<double>( total.requests ) / elapsed        << ','
+              <<  "\"lookups_per_second\":"  << static_cast<double>( total.lookups  ) / elapsed        << ','
+              <<  "\"p50_us\":"              << percentileMicroseconds( total.latencies, 50.0 )        << ','
+              <<  "\"p99_us\":"              << percentileMicroseconds( total.latencies, 99.0 )        << ','
+              <<  "\"p999_us\":"             << percentileMicroseconds( total.latencies, 99.9 )        << "}\n";
+
+    return total.errors == 0 ? 0 : 1;
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+}
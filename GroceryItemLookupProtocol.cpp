@@ -0,0 +1,251 @@
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint8_t, uint16_t, uint32_t
+#include <cstring>                                                            // memcpy()
+#include <optional>
+#include <span>
+#include <stdexcept>                                                          // length_error
+#include <string>
+#include <string_view>
+
+#include "GroceryItemLookupProtocol.hpp"
+#include "GroceryItemView.hpp"
+
+
+
+/*******************************************************************************
+**  Implementation of non-member private types, objects, and functions
+*******************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  template<typename T>
+  void put( std::string & frames, T value )
+  {
+    char bytes[sizeof( T )];
+    std::memcpy( bytes, &value, sizeof( T ) );
+    frames.append( bytes, sizeof( T ) );
+  }
+
+
+
+
+  template<typename T>
+  void overwrite( std::string & frames, std::size_t position, T value )
+  {
+    std::memcpy( frames.data() + position, &value, sizeof( T ) );
+  }
+
+
+
+
+  // Reads a frame front to back.  Every take fails, rather than reading past the end, once the frame is exhausted
+  class FrameReader
+  {
+    public:
+      explicit FrameReader( std::string_view frame ) : _rest( frame ) {}
+
+      template<typename T>
+      bool take( T & value )
+      {
+        if( _rest.size() < sizeof( T ) ) return false;
+        std::memcpy( &value, _rest.data(), sizeof( T ) );
+        _rest.remove_prefix( sizeof( T ) );
+        return true;
+      }
+
+      bool take( std::size_t length, std::string_view & text )
+      {
+        if( _rest.size() < length ) return false;
+        text = _rest.substr( 0, length );
+        _rest.remove_prefix( length );
+        return true;
+      }
+
+      bool finished() const noexcept { return _rest.empty(); }
+
+    private:
+      std::string_view _rest;
+  };
+
+
+
+
+  // Reads the length, id, and count every frame starts with, and checks the length matches the frame's size
+  bool takeHeader( FrameReader & reader, std::size_t frameSize, std::uint32_t & id, std::uint16_t & count )
+  {
+    std::uint32_t length = 0;
+    return reader.take( length ) && length + sizeof( length ) == frameSize && reader.take( id ) && reader.take( count );
+  }
+}    // unnamed, anonymous namespace
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Frames
+*******************************************************************************/
+
+// lookupFrameSize(...)
+std::size_t lookupFrameSize( std::string_view buffer, std::size_t maxFrameBytes )
+{
+  std::uint32_t length = 0;
+  if( buffer.size() < sizeof( length ) ) return 0;
+
+  std::memcpy( &length, buffer.data(), sizeof( length ) );
+  std::size_t frameSize = sizeof( length ) + length;
+  if( frameSize > maxFrameBytes ) throw std::length_error( "Error - Lookup frame of " + std::to_string( frameSize ) + " bytes exceeds the limit of " + std::to_string( maxFrameBytes ) );
+
+  return buffer.size() < frameSize ? 0 : frameSize;
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Requests
+*******************************************************************************/
+
+// appendLookupRequest(...)
+void appendLookupRequest( std::string & frames, std::uint32_t id, std::span<std::string const> upcs )
+{
+  if( upcs.size() > LOOKUP_MAX_BATCH ) throw std::length_error( "Error - A lookup request holds at most " + std::to_string( LOOKUP_MAX_BATCH ) + " UPCs" );
+
+  std::size_t frame = frames.size();
+  put<std::uint32_t>( frames, 0 );                                            // length, filled in below
+  put<std::uint32_t>( frames, id );
+  put<std::uint16_t>( frames, static_cast<std::uint16_t>( upcs.size() ) );
+
+  for( auto && upc : upcs )
+  {
+    if( upc.size() > 0xFF )
+    {
+      frames.resize( frame );
+      throw std::length_error( "Error - UPC \"" + upc + "\" is too long for a lookup request" );
+    }
+    put<std::uint8_t>( frames, static_cast<std::uint8_t>( upc.size() ) );
+    frames += upc;
+  }
+
+  // The server would close the connection over a frame it won't accept, so refuse to write one
+  if( std::size_t frameSize = frames.size() - frame; frameSize > LOOKUP_MAX_FRAME_BYTES )
+  {
+    frames.resize( frame );
+    throw std::length_error( "Error - Lookup request of " + std::to_string( frameSize ) + " bytes exceeds the limit of " + std::to_string( LOOKUP_MAX_FRAME_BYTES ) + ".  Send fewer UPCs per request" );
+  }
+
+  overwrite<std::uint32_t>( frames, frame, static_cast<std::uint32_t>( frames.size() - frame - sizeof( std::uint32_t ) ) );
+}
+
+
+
+
+// parseLookupRequest(...)
+bool parseLookupRequest( std::string_view frame, LookupRequest & request )
+{
+  FrameReader   reader( frame );
+  std::uint16_t count = 0;
+  if( !takeHeader( reader, frame.size(), request.id, count ) ) return false;
+
+  request.upcs.resize( count );
+  for( auto && upc : request.upcs )
+  {
+    std::uint8_t length = 0;
+    if( !reader.take( length ) || !reader.take( length, upc ) ) return false;
+  }
+  return reader.finished();
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Responses
+*******************************************************************************/
+
+// beginLookupResponse(...)
+std::size_t beginLookupResponse( std::string & frames, std::uint32_t id, std::size_t count )
+{
+  std::size_t frame = frames.size();
+  put<std::uint32_t>( frames, 0 );                                            // length, filled in by endLookupResponse()
+  put<std::uint32_t>( frames, id );
+  put<std::uint16_t>( frames, static_cast<std::uint16_t>( count ) );
+  return frame;
+}
+
+
+
+
+// appendLookupFound(...)
+void appendLookupFound( std::string & frames, std::string_view brandName, std::string_view productName, double price )
+{
+  if( brandName.size() > 0xFFFF || productName.size() > 0xFFFF ) throw std::length_error( "Error - Grocery item name is too long for a lookup response" );
+
+  put<std::uint8_t >( frames, static_cast<std::uint8_t>( LookupStatus::Found ) );
+  put<std::uint16_t>( frames, static_cast<std::uint16_t>( brandName.size() ) );
+  frames += brandName;
+  put<std::uint16_t>( frames, static_cast<std::uint16_t>( productName.size() ) );
+  frames += productName;
+  put<double       >( frames, price );
+}
+
+
+
+
+// appendLookupNotFound(...)
+void appendLookupNotFound( std::string & frames )
+{
+  put<std::uint8_t>( frames, static_cast<std::uint8_t>( LookupStatus::NotFound ) );
+}
+
+
+
+
+// endLookupResponse(...)
+void endLookupResponse( std::string & frames, std::size_t frame )
+{
+  overwrite<std::uint32_t>( frames, frame, static_cast<std::uint32_t>( frames.size() - frame - sizeof( std::uint32_t ) ) );
+}
+
+
+
+
+// parseLookupResponse(...)
+bool parseLookupResponse( std::string_view frame, LookupResponse & response )
+{
+  FrameReader   reader( frame );
+  std::uint16_t count = 0;
+  if( !takeHeader( reader, frame.size(), response.id, count ) ) return false;
+
+  response.items.resize( count );
+  for( auto && item : response.items )
+  {
+    std::uint8_t status = 0;
+    if( !reader.take( status ) ) return false;
+
+    if( status == static_cast<std::uint8_t>( LookupStatus::NotFound ) )
+    {
+      item.reset();
+      continue;
+    }
+    if( status != static_cast<std::uint8_t>( LookupStatus::Found ) ) return false;
+
+    GroceryItemView view;
+    std::uint16_t   length = 0;
+    if( !reader.take( length ) || !reader.take( length, view.brandName   ) ) return false;
+    if( !reader.take( length ) || !reader.take( length, view.productName ) ) return false;
+    if( !reader.take( view.price ) )                                         return false;
+    item = view;
+  }
+  return reader.finished();
+}
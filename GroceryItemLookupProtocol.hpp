@@ -0,0 +1,88 @@
+#pragma once                                                                  // include guard
+
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint8_t, uint16_t, uint32_t
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GroceryItemView.hpp"
+
+
+
+
+// The grocery item lookup protocol, spoken over a Unix domain stream socket (see GroceryItemLookupServer.cpp)
+//
+// Clients send request frames and the server answers each with one response frame, in the order the requests arrived, so a client
+// may pipeline - send many requests before reading any response - and match them up by order or by id.  Each request carries a
+// batch of UPCs.  The socket never leaves the host, so every number is in the host's native byte order and doubles are IEEE 754
+// binary64 (in Python, struct format characters prefixed with '=').
+//
+//   Request frame:
+//     length                    4 bytes   uint32, the number of bytes that follow
+//     id                        4 bytes   uint32, chosen by the client and echoed in the response
+//     count                     2 bytes   uint16, the number of UPCs in the batch
+//     UPC...                              repeated count times
+//       length                  1 byte    uint8
+//       UPC                     length bytes
+//
+//   Response frame:
+//     length                    4 bytes   uint32, the number of bytes that follow
+//     id                        4 bytes   uint32, the request's id
+//     count                     2 bytes   uint16, the request's count
+//     result...                           repeated count times, in the request's order
+//       status                  1 byte    LookupStatus
+//       if found:
+//         brand name length     2 bytes   uint16
+//         brand name            brand name length bytes
+//         product name length   2 bytes   uint16
+//         product name          product name length bytes
+//         price                 8 bytes   double
+//
+// A request frame longer than LOOKUP_MAX_FRAME_BYTES, or one whose contents don't add up to its length, is a protocol error and the
+// server closes the connection.  Response frames aren't limited; a full batch of long product names can exceed a megabyte.  The
+// server stops reading a connection while more than LOOKUP_SERVER_OUTPUT_LIMIT bytes of its responses are unsent, so a client must
+// keep reading responses while it sends, or keep less than that in flight.  A client that half closes its connection (Ex:
+// shutdown( SHUT_WR )) after sending still gets every response, then the server closes the connection.
+inline constexpr std::string_view LOOKUP_DEFAULT_SOCKET_PATH = "/tmp/GroceryItemLookup.sock";
+inline constexpr std::size_t      LOOKUP_MAX_FRAME_BYTES     = 1 << 20;
+inline constexpr std::size_t      LOOKUP_MAX_BATCH           = 0xFFFF;
+inline constexpr std::size_t      LOOKUP_HEADER_BYTES        = 4 + 4 + 2;   // length, id, count
+inline constexpr std::size_t      LOOKUP_SERVER_OUTPUT_LIMIT = 4 << 20;
+
+enum class LookupStatus : std::uint8_t { Found = 0, NotFound = 1 };
+
+
+struct LookupRequest
+{
+  std::uint32_t                 id = 0;
+  std::vector<std::string_view> upcs;                                         // views into the frame parsed
+};
+
+struct LookupResponse
+{
+  std::uint32_t                               id = 0;
+  std::vector<std::optional<GroceryItemView>> items;                          // views into the frame parsed, nullopt if not found.  The
+};                                                                            // response carries no UPCs, so upcCode is left empty
+
+
+// Returns the size of the complete frame at the front of buffer, or 0 if more bytes are needed.  Throws std::length_error if the
+// frame announces more than maxFrameBytes
+std::size_t lookupFrameSize( std::string_view buffer, std::size_t maxFrameBytes = LOOKUP_MAX_FRAME_BYTES );
+
+
+// Requests.  Throws std::length_error, leaving frames unchanged, if upcs has more than LOOKUP_MAX_BATCH UPCs, one is longer than 255
+// characters, or together they don't fit in LOOKUP_MAX_FRAME_BYTES
+void appendLookupRequest( std::string & frames, std::uint32_t id, std::span<std::string const> upcs );
+bool parseLookupRequest ( std::string_view frame, LookupRequest & request );                // false if frame is malformed
+
+
+// Responses are written a result at a time:  begin, then one append per UPC in the request, then end.  appendLookupFound() throws
+// std::length_error if a name is longer than 65535 characters
+std::size_t beginLookupResponse ( std::string & frames, std::uint32_t id, std::size_t count );  // Returns the frame's position in frames
+void        appendLookupFound   ( std::string & frames, std::string_view brandName, std::string_view productName, double price );
+void        appendLookupNotFound( std::string & frames );
+void        endLookupResponse   ( std::string & frames, std::size_t frame );
+bool        parseLookupResponse ( std::string_view frame, LookupResponse & response );      // false if frame is malformed
@@ -0,0 +1,316 @@
+#include <cerrno>                                                                         // errno, EAGAIN, EINTR, ENOENT, ECONNREFUSED
+#include <csignal>                                                                        // SIGINT, SIGTERM
+#include <cstddef>                                                                        // size_t
+#include <cstdint>                                                                        // uint32_t
+#include <cstring>                                                                        // strerror()
+#include <exception>                                                                      // exception
+#include <iostream>                                                                       // cout, cerr
+#include <stdexcept>                                                                      // runtime_error
+#include <string>
+#include <string_view>
+#include <system_error>                                                                   // system_error, generic_category()
+#include <unordered_map>
+
+#include <sys/epoll.h>                                                                    // epoll_create1(), epoll_ctl(), epoll_wait()
+#include <sys/signalfd.h>                                                                 // signalfd()
+#include <sys/socket.h>                                                                   // socket(), bind(), listen(), accept4(), send(), recv()
+#include <sys/stat.h>                                                                     // lstat(), S_ISSOCK()
+#include <sys/un.h>                                                                       // sockaddr_un
+#include <unistd.h>                                                                       // close(), unlink()
+
+#include "GroceryItem.hpp"
+#include "GroceryItemDatabase.hpp"
+#include "GroceryItemLookupProtocol.hpp"
+
+
+
+namespace
+{
+  constexpr std::size_t READ_CHUNK = 64 * 1024;
+  constexpr int         MAX_EVENTS = 64;
+
+
+
+  [[noreturn]] void systemError( std::string const & what )
+  {
+    throw std::system_error( errno, std::generic_category(), what );
+  }
+
+
+
+  // Removes the socket at path left behind by a server that didn't shut down cleanly, so the new one can bind there.  Throws rather
+  // than remove anything else:  a path that isn't a socket (a mistyped argument naming a database, say), or a socket a server is
+  // still listening on
+  void removeStaleSocket( std::string const & path, sockaddr_un const & address )
+  {
+    struct stat existing;
+    if( ::lstat( path.c_str(), &existing ) != 0 )
+    {
+      if( errno == ENOENT ) return;
+      systemError( "Error - Could not examine \"" + path + '"' );
+    }
+    if( !S_ISSOCK( existing.st_mode ) ) throw std::runtime_error( "Error - \"" + path + "\" exists and isn't a socket.  Refusing to replace it" );
+
+    int probe = ::socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if( probe < 0 ) systemError( "Error - Could not create a socket" );
+    int connected = ::connect( probe, reinterpret_cast<sockaddr const *>( &address ), sizeof( address ) );
+    int error     = errno;
+    ::close( probe );
+
+    if( connected == 0 ) throw std::runtime_error( "Error - Another server is already listening on \"" + path + '"' );
+    if( error != ECONNREFUSED )
+    {
+      errno = error;
+      systemError( "Error - Could not tell whether a server is listening on \"" + path + '"' );
+    }
+    if( ::unlink( path.c_str() ) != 0 ) systemError( "Error - Could not remove the stale socket \"" + path + '"' );
+  }
+
+
+
+  // One client connection.  Requests are answered in arrival order, so a client may pipeline as deeply as it likes; responses queue
+  // in _output until the socket takes them.  A client that stops reading its responses isn't read either, once more than
+  // LOOKUP_SERVER_OUTPUT_LIMIT bytes of them are waiting.  A client that hangs up its sending side isn't read any more, but it's
+  // still sent every response before the connection is closed
+  class Connection
+  {
+    public:
+      explicit Connection( int socket ) : _socket( socket ) {}
+
+      Connection            ( const Connection & ) = delete;
+      Connection & operator=( const Connection & ) = delete;
+     ~Connection() { ::close( _socket ); }
+
+      // Each returns false when the connection should be closed at once - the client disconnected, or broke the protocol
+      bool receive( GroceryItemDatabase & database );
+      bool transmit();
+
+      int  socket      () const noexcept { return _socket; }
+      bool wantsToRead () const noexcept { return !_hungUp && _output.size() - _sent < LOOKUP_SERVER_OUTPUT_LIMIT; }
+      bool wantsToWrite() const noexcept { return _sent < _output.size(); }
+      bool finished    () const noexcept { return _hungUp && !wantsToWrite(); }  // Returns true once a client that hung up has every response
+
+    private:
+      void answer( std::string_view frame, GroceryItemDatabase & database );
+
+      int           _socket;
+      std::string   _input;                                                               // bytes received but not yet a whole frame
+      std::string   _output;                                                              // responses not yet sent ...
+      std::size_t   _sent   = 0;                                                          // ... starting here
+      bool          _hungUp = false;                                                      // the client won't send any more
+      LookupRequest _request;                                                             // reused to save allocations
+      std::string   _upc;
+  };
+
+
+
+  // receive()
+  bool Connection::receive( GroceryItemDatabase & database )
+  {
+    // Drain the socket - it's non-blocking - then answer every whole frame received.  Batching many small requests into one read
+    // and one write is what lets a single thread keep up with many clients
+    while( _input.size() < LOOKUP_MAX_FRAME_BYTES )                                      // more stays queued in the socket for the next event
+    {
+      char chunk[READ_CHUNK];
+      auto count = ::recv( _socket, chunk, sizeof( chunk ), 0 );
+      if( count > 0 ) { _input.append( chunk, static_cast<std::size_t>( count ) );  continue; }
+
+      if( count == 0 )                                   { _hungUp = true;  break; }   // still answer what was sent before hanging up
+      if( errno == EINTR )                               continue;
+      if( errno == EAGAIN || errno == EWOULDBLOCK )      break;
+      return false;
+    }
+
+    std::string_view unanswered = _input;
+    try
+    {
+      while( std::size_t frameSize = lookupFrameSize( unanswered ) )
+      {
+        answer( unanswered.substr( 0, frameSize ), database );
+        unanswered.remove_prefix( frameSize );
+      }
+    }
+    catch( std::exception & ex )                                                       // oversized or malformed frame
+    {
+      std::cerr << "Warning:  Closing connection " << _socket << ":  " << ex.what() << '\n';
+      return false;
+    }
+    _input.erase( 0, _input.size() - unanswered.size() );
+
+    return transmit();
+  }
+
+
+
+  // answer()
+  void Connection::answer( std::string_view frame, GroceryItemDatabase & database )
+  {
+    if( !parseLookupRequest( frame, _request ) ) throw std::runtime_error( "Error - Malformed lookup request" );
+
+    std::size_t response = beginLookupResponse( _output, _request.id, _request.upcs.size() );
+    for( auto && upc : _request.upcs )
+    {
+      _upc.assign( upc );
+      if( GroceryItem * item = database.find( _upc ); item != nullptr ) appendLookupFound( _output, item->brandName(), item->productName(), item->price() );
+      else                                                             appendLookupNotFound( _output );
+    }
+    endLookupResponse( _output, response );
+  }
+
+
+
+  // transmit()
+  bool Connection::transmit()
+  {
+    while( wantsToWrite() )
+    {
+      auto count = ::send( _socket, _output.data() + _sent, _output.size() - _sent, MSG_NOSIGNAL );
+      if( count < 0 )
+      {
+        if( errno == EINTR ) continue;
+        if( errno == EAGAIN || errno == EWOULDBLOCK ) break;
+        return false;
+      }
+      _sent += static_cast<std::size_t>( count );
+    }
+
+    if( !wantsToWrite() ) { _output.clear();  _sent = 0; }
+    return true;
+  }
+}    // namespace
+
+
+
+
+// main()
+//    GroceryItemLookupServer [socketPath]
+//
+// Holds the grocery item database in memory and answers lookups over a Unix domain socket (see GroceryItemLookupProtocol.hpp for
+// the wire format), so tools written in other languages can look up UPCs without loading the database themselves.  One thread runs
+// an epoll event loop over every connection.  SIGINT or SIGTERM shuts the server down and removes the socket.  A socket left at
+// socketPath by a server that didn't shut down cleanly is replaced, but the server won't start if anything else is there, or if
+// another server is still listening on it.
+//    Ex:  GroceryItemLookupServer /tmp/GroceryItemLookup.sock
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    std::string socketPath = argc >= 2 ? argv[1] : std::string( LOOKUP_DEFAULT_SOCKET_PATH );
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if( socketPath.empty() || socketPath.size() >= sizeof( address.sun_path ) )
+    {
+      std::cerr << "Usage:  " << argv[0] << " [socketPath]\n"
+                << "        socketPath must be 1 to " << sizeof( address.sun_path ) - 1 << " characters, and defaults to " << LOOKUP_DEFAULT_SOCKET_PATH << '\n';
+      return 2;
+    }
+    socketPath.copy( address.sun_path, socketPath.size() );
+
+    GroceryItemDatabase & worldWideDatabase = GroceryItemDatabase::instance();
+
+
+    // Shut down on SIGINT and SIGTERM by way of the event loop rather than a signal handler
+    sigset_t signals;
+    sigemptyset( &signals );
+    sigaddset  ( &signals, SIGINT  );
+    sigaddset  ( &signals, SIGTERM );
+    if( ::sigprocmask( SIG_BLOCK, &signals, nullptr ) != 0 ) systemError( "Error - Could not block SIGINT and SIGTERM" );
+
+    int signalEvents = ::signalfd( -1, &signals, SFD_NONBLOCK | SFD_CLOEXEC );
+    if( signalEvents < 0 ) systemError( "Error - Could not create a signal descriptor" );
+
+
+    int listener = ::socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+    if( listener < 0 ) systemError( "Error - Could not create a socket" );
+
+    removeStaleSocket( socketPath, address );
+    if( ::bind  ( listener, reinterpret_cast<sockaddr *>( &address ), sizeof( address ) ) != 0 ) systemError( "Error - Could not bind to \"" + socketPath + '"' );
+    if( ::listen( listener, SOMAXCONN )                                                    != 0 ) systemError( "Error - Could not listen on \"" + socketPath + '"' );
+
+
+    int events = ::epoll_create1( EPOLL_CLOEXEC );
+    if( events < 0 ) systemError( "Error - Could not create an epoll instance" );
+
+    auto watch = [&]( int descriptor, std::uint32_t interest, int operation )
+    {
+      epoll_event event{};
+      event.events  = interest;
+      event.data.fd = descriptor;
+      if( ::epoll_ctl( events, operation, descriptor, &event ) != 0 ) systemError( "Error - Could not watch descriptor " + std::to_string( descriptor ) );
+    };
+    watch( listener,     EPOLLIN, EPOLL_CTL_ADD );
+    watch( signalEvents, EPOLLIN, EPOLL_CTL_ADD );
+
+    std::cout << "Serving " << worldWideDatabase.size() << " grocery items on " << socketPath << std::endl;
+
+
+    // The event loop.  Connections are level triggered:  readable while their pending output is under the limit and the client
+    // hasn't hung up, writable while they have output pending
+    std::unordered_map<int, Connection> connections;
+    auto interestIn = []( Connection const & connection ) -> std::uint32_t
+    {
+      return ( connection.wantsToRead() ? EPOLLIN | EPOLLRDHUP : 0u ) | ( connection.wantsToWrite() ? EPOLLOUT : 0u );
+    };
+
+    bool        running = true;
+    epoll_event ready[MAX_EVENTS];
+    while( running )
+    {
+      int count = ::epoll_wait( events, ready, MAX_EVENTS, -1 );
+      if( count < 0 )
+      {
+        if( errno == EINTR ) continue;
+        systemError( "Error - Waiting for events failed" );
+      }
+
+      for( int i = 0; i < count; ++i )
+      {
+        int descriptor = ready[i].data.fd;
+
+        if( descriptor == signalEvents )
+        {
+          running = false;
+        }
+
+        else if( descriptor == listener )
+        {
+          for( int client; ( client = ::accept4( listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC ) ) >= 0; )
+          {
+            auto & connection = connections.try_emplace( client, client ).first->second;
+            watch( client, interestIn( connection ), EPOLL_CTL_ADD );
+          }
+          if( errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED )
+          {
+            std::cerr << "Warning:  Could not accept a connection:  " << std::strerror( errno ) << '\n';
+          }
+        }
+
+        else if( auto connection = connections.find( descriptor ); connection != connections.end() )
+        {
+          auto before = interestIn( connection->second );
+          bool open   = !( ready[i].events & EPOLLERR );
+          if( open && ( ready[i].events & ( EPOLLIN | EPOLLRDHUP | EPOLLHUP ) ) ) open = connection->second.receive( worldWideDatabase );
+          if( open && ( ready[i].events & EPOLLOUT                           ) ) open = connection->second.transmit();
+
+          if     ( !open || connection->second.finished() )    connections.erase( connection );    // closing the socket removes it from the epoll set
+          else if( interestIn( connection->second ) != before ) watch( descriptor, interestIn( connection->second ), EPOLL_CTL_MOD );
+        }
+      }
+    }
+
+    connections.clear();
+    ::close( listener );
+    ::unlink( socketPath.c_str() );
+    ::close( events );
+    ::close( signalEvents );
+    std::cout << "Shut down" << std::endl;
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,26 @@
+#include <iomanip>                                                            // quoted()
+#include <iostream>                                                           // ostream
+#include <string>
+
+#include "GroceryItem.hpp"
+#include "GroceryItemView.hpp"
+
+
+
+// toGroceryItem()
+GroceryItem GroceryItemView::toGroceryItem() const
+{
+  return GroceryItem( std::string( productName ), std::string( brandName ), std::string( upcCode ), price );
+}
+
+
+
+
+// operator<<(...)
+std::ostream & operator<<( std::ostream & stream, GroceryItemView const & groceryItem )
+{
+  return stream << std::quoted( groceryItem.upcCode     ) << ", "
+                << std::quoted( groceryItem.brandName   ) << ", "
+                << std::quoted( groceryItem.productName ) << ", "
+                << groceryItem.price;
+}
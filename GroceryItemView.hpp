@@ -0,0 +1,23 @@
+#pragma once                                                                  // include guard
+
+#include <iosfwd>                                                             // ostream
+#include <string_view>
+
+#include "GroceryItem.hpp"
+
+
+
+
+// A read only view of a grocery item whose text lives somewhere else - in a shared memory image or a compile time table, for example
+// - so it can be handed out without allocating.  The viewed text must outlive the view.
+struct GroceryItemView
+{
+  std::string_view upcCode;
+  std::string_view brandName;
+  std::string_view productName;
+  double           price = 0.0;
+
+  GroceryItem toGroceryItem() const;                                          // Returns an owning copy
+};
+
+std::ostream & operator<<( std::ostream & stream, GroceryItemView const & groceryItem );   // Same format as GroceryItem's insertion operator
@@ -0,0 +1,40 @@
+#include <exception>                                                                      // exception
+#include <iomanip>                                                                        // quoted()
+#include <iostream>                                                                       // cin, cout, cerr
+#include <string>
+
+#include "EmbeddedGroceryCatalog.hpp"
+#include "EmbeddedGroceryCatalogData.hpp"                                                 // generated, see GroceryCatalogEmbedder.cpp
+
+
+
+// main()
+//    GroceryKioskPriceCheck [upc...]
+//
+// A price check kiosk:  prints the item for each UPC given, or for each UPC read from standard input (one per scan) if none are
+// given.  The kiosk's staples are compiled in, so they're answered immediately; anything else is looked up in the grocery item
+// database, which is loaded on the first such scan.  The build generates the catalog from the kiosk's staples, Kiosk_Staples.dat
+// unless GROCERY_KIOSK_STAPLES names another database, keeping the staple GROCERY_KIOSK_DUPLICATE_POLICY picks when several share a
+// UPC (see CMakeLists.txt), as if by:
+//    Ex:  GroceryCatalogEmbedder Kiosk_Staples.dat EmbeddedGroceryCatalogData.hpp
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    auto priceCheck = []( const std::string & upc )
+    {
+      if( auto item = EMBEDDED_GROCERY_CATALOG.find( upc ) ) std::cout << *item << '\n';
+      else                                                  std::cout << std::quoted( upc ) << " not found\n";
+    };
+
+    if( argc >= 2 ) for( int i = 1; i < argc; ++i ) priceCheck( argv[i] );
+    else            for( std::string upc; std::cin >> upc; ) priceCheck( upc );
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
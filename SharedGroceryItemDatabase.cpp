@@ -0,0 +1,419 @@
+#include <algorithm>                                                          // partition_point()
+#include <atomic>                                                             // atomic_ref
+#include <cerrno>                                                             // errno, ENOENT
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint64_t, uint32_t
+#include <cstring>                                                            // memcpy(), memcmp(), memset()
+#include <filesystem>                                                         // path, rename()
+#include <optional>
+#include <span>
+#include <stdexcept>                                                          // runtime_error, out_of_range
+#include <string>
+#include <string_view>
+#include <system_error>                                                       // system_error, generic_category()
+#include <type_traits>                                                        // is_trivially_copyable_v
+#include <utility>                                                            // exchange()
+#include <vector>
+
+#include <fcntl.h>                                                            // O_CREAT, O_EXCL, O_RDWR, O_RDONLY
+#include <sys/mman.h>                                                         // shm_open(), shm_unlink(), mmap(), munmap()
+#include <sys/stat.h>                                                         // fstat()
+#include <unistd.h>                                                           // ftruncate(), close(), getpid()
+
+#include "GroceryItem.hpp"
+#include "GroceryItemView.hpp"
+#include "SharedGroceryItemDatabase.hpp"
+#include "UpcIndex.hpp"
+
+
+
+/*******************************************************************************
+**  Implementation of non-member private types, objects, and functions
+*******************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  // The image, every region aligned to a cache line:
+  //
+  //    ImageHeader
+  //    UPC index levels        levelCount x uint64_t            (see UpcIndex)
+  //    UPC index nodes         nodeCount  x UpcIndex::Node
+  //    records                 records    x ImageRecord         sorted by UPC
+  //    text                    textBytes                        each record's UPC, brand name, and product name, back to back
+  constexpr char          IMAGE_MAGIC[8] = { 'G', 'U', 'P', 'C', 'S', 'H', 'M', '1' };
+  constexpr std::uint32_t IMAGE_VERSION  = 1;
+  constexpr std::uint32_t IMAGE_READY    = 0x5245'4459;                       // "REDY"
+  constexpr std::size_t   CACHE_LINE     = 64;
+
+  std::filesystem::path const SHARED_MEMORY_DIRECTORY = "/dev/shm";
+
+  struct ImageHeader
+  {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t ready;                                                      // IMAGE_READY once everything else is written
+    std::uint64_t bytes;
+    std::uint64_t records;
+    std::uint64_t recordsOffset;
+    std::uint64_t textOffset;
+    std::uint64_t textBytes;
+    std::uint64_t indexed;                                                    // 0 if some UPC isn't packable, and there's no index
+    std::uint64_t levelsOffset;
+    std::uint64_t levelCount;
+    std::uint64_t nodesOffset;
+    std::uint64_t nodeCount;
+    std::uint64_t largestKey;
+  };
+
+  struct ImageRecord
+  {
+    std::uint64_t text;                                                       // offset of the UPC within the text region
+    std::uint32_t upcLength;
+    std::uint32_t brandNameLength;
+    std::uint32_t productNameLength;
+    std::uint32_t reserved;
+    double        price;
+  };
+
+  static_assert( std::is_trivially_copyable_v<ImageHeader> && std::is_trivially_copyable_v<ImageRecord> && std::is_trivially_copyable_v<UpcIndex::Node> );
+
+
+
+
+  std::size_t alignUp( std::size_t value, std::size_t alignment )
+  {
+    return ( value + alignment - 1 ) / alignment * alignment;
+  }
+
+
+
+
+  template<typename T>
+  T const * region( void const * image, std::uint64_t offset )
+  {
+    return reinterpret_cast<T const *>( static_cast<char const *>( image ) + offset );
+  }
+
+
+
+
+  ImageHeader const & header( void const * image )
+  {
+    return *region<ImageHeader>( image, 0 );
+  }
+
+
+
+
+  // The ready flag is only ever read through a read only mapping.  A 32-bit atomic load doesn't write (it's an ordinary load on every
+  // platform we run on), so casting away const to reach atomic_ref, which requires a non-const object, is safe.
+  std::uint32_t loadReady( ImageHeader const & header )
+  {
+    return std::atomic_ref<std::uint32_t>( const_cast<std::uint32_t &>( header.ready ) ).load( std::memory_order_acquire );
+  }
+
+
+
+
+  [[noreturn]] void systemError( std::string const & what )
+  {
+    throw std::system_error( errno, std::generic_category(), what );
+  }
+}    // unnamed, anonymous namespace
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Publishing and attaching
+*******************************************************************************/
+
+// publish(...)
+void SharedGroceryItemDatabase::publish( std::string const & name, std::span<GroceryItem const> items )
+{
+  // Index the UPCs the same way GroceryItemDatabase does
+  std::vector<UpcIndex::Key> keys;
+  keys.reserve( items.size() );
+  for( auto && item : items )
+  {
+    auto key = UpcIndex::pack( item.upcCode() );
+    if( !key ) { keys.clear();  break; }
+    keys.push_back( *key );
+  }
+  bool     indexed = keys.size() == items.size() && !items.empty();
+  UpcIndex index   = indexed ? UpcIndex( keys ) : UpcIndex{};
+
+
+  // Lay out the image
+  std::size_t textBytes = 0;
+  for( auto && item : items ) textBytes += item.upcCode().size() + item.brandName().size() + item.productName().size();
+
+  ImageHeader layout{};
+  std::memcpy( layout.magic, IMAGE_MAGIC, sizeof( IMAGE_MAGIC ) );
+  layout.version       = IMAGE_VERSION;
+  layout.records       = items.size();
+  layout.textBytes     = textBytes;
+  layout.indexed       = indexed;
+  layout.levelCount    = index.levels().size();
+  layout.nodeCount     = index.nodes ().size();
+  layout.largestKey    = index.largest();
+  layout.levelsOffset  = alignUp( sizeof( ImageHeader ),                                              CACHE_LINE );
+  layout.nodesOffset   = alignUp( layout.levelsOffset  + layout.levelCount * sizeof( std::uint64_t ),  CACHE_LINE );
+  layout.recordsOffset = alignUp( layout.nodesOffset   + layout.nodeCount  * sizeof( UpcIndex::Node ), CACHE_LINE );
+  layout.textOffset    = alignUp( layout.recordsOffset + layout.records    * sizeof( ImageRecord ),    CACHE_LINE );
+  layout.bytes         = layout.textOffset + textBytes;
+
+
+  // Build the image under a temporary name and then rename it over any earlier image.  The rename is atomic, so a process attaching
+  // meanwhile maps either the earlier image or this one, never nothing.  Processes attached to the earlier image keep their mapping;
+  // it's freed when the last one detaches.
+  std::string building = name + ".publishing-" + std::to_string( ::getpid() );
+  auto        abandon  = [&]( std::string const & what )                        // Removes the partial image and reports what failed
+  {
+    int error = errno;
+    ::shm_unlink( building.c_str() );
+    throw std::system_error( error, std::generic_category(), what );
+  };
+
+  ::shm_unlink( building.c_str() );                                             // left behind by a publisher with our pid that died
+  int descriptor = ::shm_open( building.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644 );
+  if( descriptor < 0 ) systemError( "Error - Could not create shared memory object \"" + building + '"' );
+
+  if( ::ftruncate( descriptor, static_cast<off_t>( layout.bytes ) ) != 0 )
+  {
+    ::close( descriptor );
+    abandon( "Error - Could not size shared memory object \"" + building + '"' );
+  }
+
+  void * image = ::mmap( nullptr, layout.bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0 );
+  ::close( descriptor );
+  if( image == MAP_FAILED ) abandon( "Error - Could not map shared memory object \"" + building + '"' );
+
+  // An empty index has no levels or nodes, and memcpy() from their null data() is undefined even for zero bytes
+  char * base = static_cast<char *>( image );
+  if( layout.levelCount > 0 ) std::memcpy( base + layout.levelsOffset, index.levels().data(), layout.levelCount * sizeof( std::uint64_t  ) );
+  if( layout.nodeCount  > 0 ) std::memcpy( base + layout.nodesOffset,  index.nodes ().data(), layout.nodeCount  * sizeof( UpcIndex::Node ) );
+
+  auto *        records = reinterpret_cast<ImageRecord *>( base + layout.recordsOffset );
+  std::uint64_t text    = 0;
+  for( auto && item : items )
+  {
+    *records++ = { text, static_cast<std::uint32_t>( item.upcCode().size() ), static_cast<std::uint32_t>( item.brandName().size() ),
+                   static_cast<std::uint32_t>( item.productName().size() ), 0, item.price() };
+    for( std::string const * field : { &item.upcCode(), &item.brandName(), &item.productName() } )
+    {
+      std::memcpy( base + layout.textOffset + text, field->data(), field->size() );
+      text += field->size();
+    }
+  }
+
+
+  // Publish the header last:  a process attaching before the ready flag is set will refuse the image
+  auto & published = *reinterpret_cast<ImageHeader *>( base );
+  layout.ready = 0;
+  std::memcpy( &published, &layout, sizeof( layout ) );
+  std::atomic_ref<std::uint32_t>( published.ready ).store( IMAGE_READY, std::memory_order_release );
+
+  ::munmap( image, layout.bytes );
+
+
+  // POSIX has no shm_rename(), but Linux keeps shared memory objects as files in SHARED_MEMORY_DIRECTORY, named without the slash
+  std::error_code renamed;
+  std::filesystem::rename( SHARED_MEMORY_DIRECTORY / building.substr( 1 ), SHARED_MEMORY_DIRECTORY / name.substr( 1 ), renamed );
+  if( renamed )
+  {
+    ::shm_unlink( building.c_str() );
+    throw std::system_error( renamed, "Error - Could not replace shared memory object \"" + name + '"' );
+  }
+}
+
+
+
+
+// unpublish(...)
+void SharedGroceryItemDatabase::unpublish( std::string const & name )
+{
+  if( ::shm_unlink( name.c_str() ) != 0 && errno != ENOENT ) systemError( "Error - Could not remove shared memory object \"" + name + '"' );
+}
+
+
+
+
+// attach(...)
+SharedGroceryItemDatabase SharedGroceryItemDatabase::attach( std::string const & name )
+{
+  int descriptor = ::shm_open( name.c_str(), O_RDONLY, 0 );
+  if( descriptor < 0 ) systemError( "Error - Could not open shared memory object \"" + name + "\".  Has the database been published?" );
+
+  struct stat status{};
+  if( ::fstat( descriptor, &status ) != 0 )
+  {
+    ::close( descriptor );
+    systemError( "Error - Could not determine the size of shared memory object \"" + name + '"' );
+  }
+
+  std::size_t bytes = static_cast<std::size_t>( status.st_size );
+  if( bytes < sizeof( ImageHeader ) )
+  {
+    ::close( descriptor );
+    throw std::runtime_error( "Error - Shared memory object \"" + name + "\" is not a grocery item database image (or is still being published)" );
+  }
+
+  void * image = ::mmap( nullptr, bytes, PROT_READ, MAP_SHARED, descriptor, 0 );
+  ::close( descriptor );
+  if( image == MAP_FAILED ) systemError( "Error - Could not map shared memory object \"" + name + '"' );
+
+  SharedGroceryItemDatabase database( image, bytes );                         // now owns the mapping, even if validation throws
+
+  ImageHeader const & layout = header( image );
+  if( loadReady( layout ) != IMAGE_READY )                                  throw std::runtime_error( "Error - Shared memory object \"" + name + "\" is still being published" );
+  if( std::memcmp( layout.magic, IMAGE_MAGIC, sizeof( IMAGE_MAGIC ) ) != 0
+   || layout.version != IMAGE_VERSION )                                     throw std::runtime_error( "Error - Shared memory object \"" + name + "\" is not a version " + std::to_string( IMAGE_VERSION ) + " grocery item database image" );
+  if( layout.bytes != bytes
+   || layout.levelsOffset  + layout.levelCount * sizeof( std::uint64_t  ) > layout.nodesOffset
+   || layout.nodesOffset   + layout.nodeCount  * sizeof( UpcIndex::Node ) > layout.recordsOffset
+   || layout.recordsOffset + layout.records    * sizeof( ImageRecord    ) > layout.textOffset
+   || layout.textOffset    + layout.textBytes                             > layout.bytes )   throw std::runtime_error( "Error - Shared memory object \"" + name + "\" is corrupt" );
+
+  return database;
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Construction and destruction
+*******************************************************************************/
+
+// SharedGroceryItemDatabase(...)
+SharedGroceryItemDatabase::SharedGroceryItemDatabase( void const * image, std::size_t bytes )
+  : _image( image ),
+    _bytes( bytes )
+{}
+
+
+
+
+// Move constructor
+SharedGroceryItemDatabase::SharedGroceryItemDatabase( SharedGroceryItemDatabase && other ) noexcept
+  : _image( std::exchange( other._image, nullptr ) ),
+    _bytes( std::exchange( other._bytes, 0       ) )
+{}
+
+
+
+
+// Move Assignment Operator
+SharedGroceryItemDatabase & SharedGroceryItemDatabase::operator=( SharedGroceryItemDatabase && rhs ) noexcept
+{
+  if( this != &rhs )
+  {
+    if( _image != nullptr ) ::munmap( const_cast<void *>( _image ), _bytes );
+    _image = std::exchange( rhs._image, nullptr );
+    _bytes = std::exchange( rhs._bytes, 0       );
+  }
+  return *this;
+}
+
+
+
+
+// Destructor
+SharedGroceryItemDatabase::~SharedGroceryItemDatabase() noexcept
+{
+  if( _image != nullptr ) ::munmap( const_cast<void *>( _image ), _bytes );
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Queries
+*******************************************************************************/
+
+// find(...)
+std::optional<GroceryItemView> SharedGroceryItemDatabase::find( std::string_view upc ) const
+{
+  auto position = lowerBound( upc );
+  if( position < size() )
+  {
+    if( auto item = at( position ); item.upcCode == upc ) return item;
+  }
+  return std::nullopt;
+}
+
+
+
+
+// lowerBound(...)
+std::size_t SharedGroceryItemDatabase::lowerBound( std::string_view upc ) const
+{
+  ImageHeader const & layout = header( _image );
+
+  if( layout.indexed != 0 )
+  {
+    if( auto key = UpcIndex::pack( upc ) )
+    {
+      return UpcIndex::lowerBound( { region<UpcIndex::Node>( _image, layout.nodesOffset  ), layout.nodeCount  },
+                                   { region<std::uint64_t >( _image, layout.levelsOffset ), layout.levelCount },
+                                   layout.records, layout.largestKey, *key );
+    }
+  }
+
+  // Either the UPCs aren't all packable, or the one sought isn't.  Fall back to comparing strings.
+  std::size_t first = 0, count = layout.records;
+  while( count > 0 )
+  {
+    std::size_t half = count / 2;
+    if( at( first + half ).upcCode < upc ) { first += half + 1;  count -= half + 1; }
+    else                                     count  = half;
+  }
+  return first;
+}
+
+
+
+
+// size()
+std::size_t SharedGroceryItemDatabase::size() const noexcept
+{
+  return _image == nullptr ? 0 : header( _image ).records;
+}
+
+
+
+
+// at(...)
+GroceryItemView SharedGroceryItemDatabase::at( std::size_t position ) const
+{
+  if( position >= size() ) throw std::out_of_range( "Error - Position " + std::to_string( position ) + " is past the end of the shared grocery item database" );
+
+  ImageHeader const & layout = header( _image );
+  ImageRecord const & record = region<ImageRecord>( _image, layout.recordsOffset )[position];
+  char const *        text   = region<char>( _image, layout.textOffset + record.text );
+
+  return { { text,                                               record.upcLength         },
+           { text + record.upcLength,                            record.brandNameLength   },
+           { text + record.upcLength + record.brandNameLength,   record.productNameLength },
+           record.price };
+}
+
+
+
+
+// bytes()
+std::size_t SharedGroceryItemDatabase::bytes() const noexcept
+{
+  return _bytes;
+}
@@ -0,0 +1,63 @@
+#pragma once                                                                  // include guard
+
+#include <cstddef>                                                            // size_t
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "GroceryItem.hpp"
+#include "GroceryItemView.hpp"
+
+
+
+
+// A grocery item database shared by every process on the host
+//
+// One process (see GroceryItemDatabasePublisher.cpp) loads the database and publishes an immutable image of it - the records, their
+// text, and the UPC index - into a POSIX shared memory object.  Every other process attaches to the image read only and searches it
+// in place, so the database's memory is paid for once per host rather than once per checkout lane, and attaching costs a single
+// mmap() instead of reading and parsing the database file.
+//
+// The image holds offsets, never pointers, so it can be mapped at any address.  Its header is written last, with release semantics,
+// and attaching checks it, so a process never sees a partially written image.  Publishing again builds the new image under a
+// temporary name and atomically renames it over the old one:  processes attaching meanwhile get the old image, those attaching
+// afterwards get the new one, and processes already attached keep the image they mapped.
+class SharedGroceryItemDatabase
+{
+  public:
+    static constexpr std::string_view DEFAULT_NAME = "/GroceryItemDatabase";  // shared memory object names start with a slash
+
+
+    // Writes an image of items, which must be sorted by UPC, to the shared memory object called name
+    static void publish  ( std::string const & name, std::span<GroceryItem const> items );
+    static void unpublish( std::string const & name );                        // Removes the shared memory object.  Attached processes are unaffected
+
+    // Maps the image published under name read only.  Throws std::runtime_error if there is no such image or it isn't valid
+    static SharedGroceryItemDatabase attach( std::string const & name = std::string( DEFAULT_NAME ) );
+
+
+    // Construction and destruction.  Moving transfers the mapping, copying is prohibited
+    SharedGroceryItemDatabase            ( SharedGroceryItemDatabase && other ) noexcept;
+    SharedGroceryItemDatabase & operator=( SharedGroceryItemDatabase && rhs   ) noexcept;
+    SharedGroceryItemDatabase            ( SharedGroceryItemDatabase const &  ) = delete;
+    SharedGroceryItemDatabase & operator=( SharedGroceryItemDatabase const &  ) = delete;
+   ~SharedGroceryItemDatabase() noexcept;
+
+
+    // Locate a particular record.  The view's text lives in the image and is valid as long as this object is
+    std::optional<GroceryItemView> find( std::string_view upc ) const;        // Returns nullopt if not found
+
+    // Queries
+    std::size_t     size () const noexcept;                                   // Returns the number of items in the database
+    GroceryItemView at   ( std::size_t position ) const;                      // Returns the item at position, in UPC order
+    std::size_t     bytes() const noexcept;                                   // Returns the size of the image
+
+  private:
+    SharedGroceryItemDatabase( void const * image, std::size_t bytes );
+
+    std::size_t lowerBound( std::string_view upc ) const;
+
+    void const * _image = nullptr;
+    std::size_t  _bytes = 0;
+};
@@ -0,0 +1,191 @@
+#include <algorithm>                                                          // min(), reverse()
+#include <cstddef>                                                            // size_t
+#include <limits>                                                             // numeric_limits
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>                                                            // move()
+#include <vector>
+
+#include "UpcIndex.hpp"
+
+
+
+/*******************************************************************************
+**  Key packing
+*******************************************************************************/
+
+// pack(...)
+std::optional<UpcIndex::Key> UpcIndex::pack( std::string_view upc ) noexcept
+{
+  if( upc.size() > MAX_PACKED_DIGITS ) return std::nullopt;
+
+  Key key = 0;
+  for( std::size_t i = 0; i < MAX_PACKED_DIGITS; ++i )
+  {
+    Key nibble = 0;                                                           // absent digits sort before all present digits
+    if( i < upc.size() )
+    {
+      if( upc[i] < '0' || upc[i] > '9' ) return std::nullopt;
+      nibble = static_cast<Key>( upc[i] - '0' ) + 1;
+    }
+    key = ( key << 4 ) | nibble;
+  }
+  return key;
+}
+
+
+
+
+// prefixRange(...)
+std::optional<UpcIndex::KeyRange> UpcIndex::prefixRange( std::string_view prefix ) noexcept
+{
+  if( prefix.empty() ) return std::nullopt;                                  // every key matches, and the range's end doesn't fit in a Key
+
+  auto first = pack( prefix );
+  if( !first ) return std::nullopt;
+
+  return KeyRange{ *first, *first + ( Key{ 1 } << 4 * ( MAX_PACKED_DIGITS - prefix.size() ) ) };
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Constructors
+*******************************************************************************/
+
+// UpcIndex(...)
+UpcIndex::UpcIndex( std::vector<Key> const & sortedKeys )
+  : _size( sortedKeys.size() )
+{
+  if( sortedKeys.empty() ) return;
+  _largest = sortedKeys.back();
+
+  // Build the levels bottom up:  the leaves are the sorted keys, and each level above summarizes every node below it by that node's
+  // largest key.  Stop once a level fits in a single (root) node.
+  std::vector<std::vector<Key>> levels{ sortedKeys };
+  while( levels.back().size() > NODE_WIDTH )
+  {
+    auto const & below = levels.back();
+    std::vector<Key> above;
+    above.reserve( below.size() / NODE_WIDTH + 1 );
+    for( std::size_t first = 0; first < below.size(); first += NODE_WIDTH ) above.push_back( below[ std::min( first + NODE_WIDTH, below.size() ) - 1 ] );
+    levels.push_back( std::move( above ) );
+  }
+  std::reverse( levels.begin(), levels.end() );
+
+
+  // Then lay them out root first, padding each level's last node
+  for( auto && level : levels )
+  {
+    _levels.push_back( _nodes.size() );
+    for( std::size_t first = 0; first < level.size(); first += NODE_WIDTH )
+    {
+      Node & node = _nodes.emplace_back();
+      for( std::size_t slot = 0; slot < NODE_WIDTH; ++slot )
+      {
+        node.keys[slot] = first + slot < level.size() ? level[first + slot] : std::numeric_limits<Key>::max();
+      }
+    }
+  }
+}
+
+
+
+
+
+
+
+
+/*******************************************************************************
+**  Queries
+*******************************************************************************/
+
+// lowerBound(...)
+std::size_t UpcIndex::lowerBound( Key key ) const noexcept
+{
+  return lowerBound( _nodes, _levels, _size, _largest, key );
+}
+
+
+
+
+// lowerBound(...) - over a raw layout
+std::size_t UpcIndex::lowerBound( std::span<Node const> nodes, std::span<std::uint64_t const> levels, std::size_t size, Key largest, Key key ) noexcept
+{
+  if( size == 0 || largest < key ) return size;
+
+  // Now some key is not less than the one sought, so in every node visited the count of smaller keys lands on a real slot.  That
+  // slot's child, at the next level down, is the node to search next.  Counting (rather than stopping at the first larger key)
+  // keeps the loop branch free and lets the compiler compare all eight keys at once.
+  std::size_t position = 0;
+  for( auto level : levels )
+  {
+    Node const & node = nodes[level + position];
+
+    std::size_t smaller = 0;
+    for( std::size_t slot = 0; slot < NODE_WIDTH; ++slot ) smaller += node.keys[slot] < key;
+
+    position = position * NODE_WIDTH + smaller;
+  }
+  return position;
+}
+
+
+
+
+// size()
+std::size_t UpcIndex::size() const noexcept
+{
+  return _size;
+}
+
+
+
+
+// empty()
+bool UpcIndex::empty() const noexcept
+{
+  return _size == 0;
+}
+
+
+
+
+// depth()
+std::size_t UpcIndex::depth() const noexcept
+{
+  return _levels.size();
+}
+
+
+
+
+// nodes()
+std::span<UpcIndex::Node const> UpcIndex::nodes() const noexcept
+{
+  return _nodes;
+}
+
+
+
+
+// levels()
+std::span<std::uint64_t const> UpcIndex::levels() const noexcept
+{
+  return _levels;
+}
+
+
+
+
+// largest()
+UpcIndex::Key UpcIndex::largest() const noexcept
+{
+  return _largest;
+}
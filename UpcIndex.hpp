@@ -0,0 +1,72 @@
+#pragma once                                                                  // include guard
+
+#include <cstddef>                                                            // size_t
+#include <cstdint>                                                            // uint64_t
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+
+
+
+// A static, cache-conscious search structure over packed UPC keys
+//
+// The sorted keys are stored as the leaf level of an implicit B+-tree whose nodes are exactly one 64-byte cache line (eight keys).
+// Each level above holds the largest key of every node in the level below, so a search costs one cache line per level - about 8
+// for 50M keys - instead of the ~26 scattered probes of a binary search, and the top few levels are small enough to stay in cache.
+// Because the leaves are the sorted keys themselves, the node and slot a search ends on give its rank directly.  See "Static
+// B-Trees" at https://en.algorithmica.org/hpc/data-structures/s-tree/
+class UpcIndex
+{
+  public:
+    // A UPC of up to 16 decimal digits is packed into 64 bits, one nibble per digit, most significant digit first.  Each digit d is
+    // stored as d+1 so an absent (trailing) digit, stored as 0, orders before every present digit.  The packing is therefore
+    // one-to-one and order preserving:  for packable UPCs a and b,  a < b  (as strings) if and only if  pack(a) < pack(b).  That lets
+    // 12 and 14-digit codes (Ex: 051600080015, 05017402006207) share one integer key space.
+    using Key = std::uint64_t;
+    static constexpr std::size_t MAX_PACKED_DIGITS = 16;
+
+    static std::optional<Key> pack( std::string_view upc ) noexcept;         // Returns nullopt if upc is not at most 16 decimal digits
+
+    // Every UPC starting with a packable prefix packs into the half open interval [pack(prefix), pack(prefix) + 1 in the prefix's
+    // last digit).  (The prefix's last nibble is at most 10, so adding 1 never carries into the digit before it.)
+    struct KeyRange { Key first;  Key last; };                                // Keys k in the range satisfy first <= k < last
+    static std::optional<KeyRange> prefixRange( std::string_view prefix ) noexcept;   // Returns nullopt if prefix is empty or not packable
+
+
+    // Constructors
+    UpcIndex() = default;
+    explicit UpcIndex( std::vector<Key> const & sortedKeys );                 // Keys must already be sorted in non-decreasing order
+
+
+    // Queries
+    std::size_t lowerBound( Key key ) const noexcept;                         // Returns the sorted position (rank) of the first key not less
+                                                                              // than key, or size() if every key is less than key
+    std::size_t size () const noexcept;                                       // Returns the number of keys indexed
+    bool        empty() const noexcept;
+    std::size_t depth() const noexcept;                                       // Returns the number of nodes (cache lines) a search visits
+
+
+    // The raw layout, for copying the index somewhere these vectors can't go (Ex: a shared memory image).  The layout holds no
+    // pointers, so a byte for byte copy searched with the static lowerBound below gives the same answers as this object.
+    static constexpr std::size_t NODE_WIDTH = 8;                              // keys per node, 8 x 8 bytes = one cache line
+
+    struct alignas( 64 ) Node
+    {
+      Key keys[NODE_WIDTH];                                                   // unused trailing slots hold the largest Key, which no packed UPC reaches
+    };
+
+    std::span<Node const>          nodes  () const noexcept;
+    std::span<std::uint64_t const> levels () const noexcept;
+    Key                            largest() const noexcept;
+
+    static std::size_t lowerBound( std::span<Node const> nodes, std::span<std::uint64_t const> levels,
+                                   std::size_t size, Key largest, Key key ) noexcept;
+
+  private:
+    std::vector<Node>          _nodes;                                        // all levels, root first, each level's nodes contiguous
+    std::vector<std::uint64_t> _levels;                                       // _levels[i] is the position in _nodes of level i's first node
+    std::size_t                _size    = 0;
+    Key                      _largest = 0;                                    // the largest key indexed
+};
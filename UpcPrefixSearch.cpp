@@ -0,0 +1,38 @@
+#include <exception>                                                                      // exception
+#include <iostream>                                                                       // cout, cerr
+
+#include "GroceryItem.hpp"
+#include "GroceryItemDatabase.hpp"
+
+
+
+// main()
+//    UpcPrefixSearch prefix...
+//
+// Prints every grocery item whose UPC starts with one of the given prefixes, one per line in the database's own format, so vendor
+// recall lists can be pulled without dumping and grepping the whole database.  Ex:  UpcPrefixSearch 00038000
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    if( argc < 2 )
+    {
+      std::cerr << "Usage:  " << argv[0] << " prefix...\n";
+      return 2;
+    }
+
+    GroceryItemDatabase & worldWideDatabase = GroceryItemDatabase::instance();
+
+    for( int i = 1; i < argc; ++i )
+    {
+      for( auto && item : worldWideDatabase.findByPrefix( argv[i] ) ) std::cout << item << '\n';
+    }
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,146 @@
+#include <algorithm>                                                                      // find(), lower_bound(), sort(), min()
+#include <chrono>                                                                         // steady_clock
+#include <cstddef>                                                                        // size_t
+#include <cstdint>                                                                        // uint64_t
+#include <cstdlib>                                                                        // strtoull()
+#include <exception>                                                                      // exception
+#include <iostream>                                                                       // cerr
+#include <random>                                                                         // mt19937_64
+#include <stdexcept>                                                                      // logic_error
+#include <string>
+#include <vector>
+
+#include "BenchmarkReport.hpp"
+#include "UpcIndex.hpp"
+
+
+
+namespace
+{
+  // Make a random 12 or 14-digit UPC.  Real codes cluster under a manufacturer prefix, so draw the leading digits from a small pool
+  std::string randomUpc( std::mt19937_64 & generator )
+  {
+    static const std::vector<std::string> prefixes = { "00038000", "00024600", "00041520", "00075457", "00688267", "0503", "09073649" };
+
+    std::string upc = prefixes[ generator() % prefixes.size() ];
+    std::size_t length = generator() % 2 == 0 ? 12 : 14;
+    while( upc.size() < length ) upc += static_cast<char>( '0' + generator() % 10 );
+    return upc;
+  }
+
+
+
+  // Time body() over every query and report it (see BenchmarkReport.hpp).  The accumulated checksum is reported so the optimizer
+  // can't discard the work.
+  template<typename Body>
+  void measure( const char * name, std::size_t records, std::vector<std::string> const & queries, Body body )
+  {
+    std::size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for( auto && query : queries ) checksum += body( query );
+    auto stop  = std::chrono::steady_clock::now();
+
+    report( name, records, queries.size(), stop - start, static_cast<double>( checksum ) );
+  }
+}    // namespace
+
+
+
+
+// main()
+//    UpcSearchBenchmark [records [queries]]
+//
+// Compares the file order linear search GroceryItemDatabase used to do, std::lower_bound over sorted strings and over sorted packed
+// keys, and the static B+-tree UpcIndex.  Each measurement is a line of JSON, the same as GroceryItemDatabaseBenchmark's, with a
+// query per operation
+int main( int argc, char * argv[] )
+{
+  try
+  {
+    std::size_t records = argc >= 2 ? std::strtoull( argv[1], nullptr, 10 ) : 1'000'000;
+    std::size_t queries = argc >= 3 ? std::strtoull( argv[2], nullptr, 10 ) :   200'000;
+
+    if( records == 0 || queries == 0 )
+    {
+      std::cerr << "Usage:  " << argv[0] << " [records [queries]]\n"
+                << "        both positive, and default to 1000000 and 200000\n";
+      return 2;
+    }
+
+    std::mt19937_64 generator( 20240229 );
+
+    std::vector<std::string> fileOrder;
+    fileOrder.reserve( records );
+    for( std::size_t i = 0; i < records; ++i ) fileOrder.push_back( randomUpc( generator ) );
+
+    std::vector<std::string> sortedUpcs( fileOrder );
+    std::sort( sortedUpcs.begin(), sortedUpcs.end() );
+
+    std::vector<UpcIndex::Key> sortedKeys;
+    sortedKeys.reserve( records );
+    for( auto && upc : sortedUpcs ) sortedKeys.push_back( *UpcIndex::pack( upc ) );
+
+    UpcIndex index( sortedKeys );
+
+
+    // Half the queries hit, half (almost surely) miss
+    std::vector<std::string> hits, misses;
+    for( std::size_t i = 0; i < queries; ++i ) hits  .push_back( fileOrder[ generator() % records ] );
+    for( std::size_t i = 0; i < queries; ++i ) misses.push_back( randomUpc( generator ) );
+
+
+    auto linear = [&]( std::string const & upc ) -> std::size_t
+    {
+      return static_cast<std::size_t>( std::find( fileOrder.begin(), fileOrder.end(), upc ) - fileOrder.begin() );
+    };
+    auto stringLowerBound = [&]( std::string const & upc ) -> std::size_t
+    {
+      return static_cast<std::size_t>( std::lower_bound( sortedUpcs.begin(), sortedUpcs.end(), upc ) - sortedUpcs.begin() );
+    };
+    auto keyLowerBound = [&]( std::string const & upc ) -> std::size_t
+    {
+      return static_cast<std::size_t>( std::lower_bound( sortedKeys.begin(), sortedKeys.end(), *UpcIndex::pack( upc ) ) - sortedKeys.begin() );
+    };
+    auto upcIndex = [&]( std::string const & upc ) -> std::size_t
+    {
+      return index.lowerBound( *UpcIndex::pack( upc ) );
+    };
+
+    // A range scan over a manufacturer's block of codes:  two searches plus a walk over the (contiguous) result
+    auto indexRange = [&]( std::string const & upc ) -> std::size_t
+    {
+      auto range = *UpcIndex::prefixRange( upc.substr( 0, 8 ) );
+      auto from  = index.lowerBound( range.first );
+      auto to    = index.lowerBound( range.last  );
+      std::size_t sum = 0;
+      for( auto i = from; i < to; ++i ) sum += static_cast<std::size_t>( sortedKeys[i] >> 32 );
+      return sum;
+    };
+
+
+    for( auto && query : hits   ) if( upcIndex( query ) != keyLowerBound( query ) ) throw std::logic_error( "Error - UpcIndex disagrees with std::lower_bound for " + query );
+    for( auto && query : misses ) if( upcIndex( query ) != keyLowerBound( query ) ) throw std::logic_error( "Error - UpcIndex disagrees with std::lower_bound for " + query );
+
+
+    // Linear search is O(n) per query, so it's only given a small sample to keep the run time reasonable
+    std::vector<std::string> linearHits  ( hits  .begin(), hits  .begin() + static_cast<std::ptrdiff_t>( std::min<std::size_t>( hits  .size(), 1'000 ) ) );
+    std::vector<std::string> linearMisses( misses.begin(), misses.begin() + static_cast<std::ptrdiff_t>( std::min<std::size_t>( misses.size(), 1'000 ) ) );
+    measure( "linear_hit",                  records, linearHits,   linear           );
+    measure( "linear_miss",                 records, linearMisses, linear           );
+
+    measure( "lower_bound_string_hit",      records, hits,         stringLowerBound );
+    measure( "lower_bound_string_miss",     records, misses,       stringLowerBound );
+    measure( "lower_bound_packed_key_hit",  records, hits,         keyLowerBound    );
+    measure( "lower_bound_packed_key_miss", records, misses,       keyLowerBound    );
+    measure( "upc_index_hit",               records, hits,         upcIndex         );
+    measure( "upc_index_miss",              records, misses,       upcIndex         );
+    measure( "upc_index_prefix_range_scan", records, hits,         indexRange       );
+  }
+
+  catch( std::exception & ex )
+  {
+    std::cerr << "ERROR:  Unhandled exception:  " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}